@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# Check that the liquid mass in droplets and wall film is conserved between
+# the spray ASCII files written with particles.write_ascii_files = 1. Used by
+# run_film_test.sh, where evaporation is off so the liquid mass can only
+# change through errors in splashing or film transport
+import argparse
+import math
+import sys
+
+parser = argparse.ArgumentParser()
+parser.add_argument("files", help="Spray ASCII files in time order", nargs='+', type=str)
+parser.add_argument("--dim", help="Number of dimensions", default=3, type=int)
+parser.add_argument("--nfuel", help="SPRAY_FUEL_NUM used for the build", default=2, type=int)
+parser.add_argument("--rho", help="Liquid density, must be constant", default=0.693, type=float)
+parser.add_argument("--tol", help="Relative tolerance on the liquid mass", default=1.E-10, type=float)
+args = parser.parse_args()
+
+# Offsets of the parcel data in each line: position, ID, CPU, then SprayComps
+rstart = args.dim + 2
+dia_indx = rstart + args.dim + 1
+numdens_indx = rstart + args.dim + 2 + args.nfuel
+film_indx = numdens_indx + 4
+num_reals = args.dim + args.nfuel + 7
+
+def liquid_mass(fname):
+    drop_mass = 0.
+    film_mass = 0.
+    with open(fname) as pfile:
+        for line in pfile:
+            vals = line.split()
+            # Skip the header lines
+            if (len(vals) < rstart + num_reals):
+                continue
+            dia = float(vals[dia_indx])
+            num_dens = float(vals[numdens_indx])
+            film_hght = float(vals[film_indx])
+            if (film_hght > 0.):
+                film_mass += num_dens * args.rho * 0.25 * math.pi * dia**2 * film_hght
+            else:
+                drop_mass += num_dens * args.rho * math.pi / 6. * dia**3
+    return drop_mass, film_mass
+
+ref_mass = None
+max_err = 0.
+for fname in args.files:
+    drop_mass, film_mass = liquid_mass(fname)
+    tot_mass = drop_mass + film_mass
+    if (ref_mass is None):
+        ref_mass = tot_mass
+    err = abs(tot_mass - ref_mass) / ref_mass
+    max_err = max(max_err, err)
+    print("{}: droplet mass {:.10e}, film mass {:.10e}, relative error {:.3e}".format(fname, drop_mass, film_mass, err))
+if (max_err > args.tol):
+    print("FAILED: liquid mass changed by {:.3e}".format(max_err))
+    sys.exit(1)
+print("PASSED")
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# Wall film mass conservation check: the droplets of first-input splash on
+# the EB plane with film transport on and evaporation off, and the liquid mass
+# in droplets and film is compared between the spray ASCII files
+set -e
+EXEC="./PeleC3d.llvm.ex"
+RUN=""
+TPD="film_files"
+mkdir -p ${TPD}
+
+${RUN} ${EXEC} first-input \
+        amr.plot_file = ${TPD}/plt \
+        amr.plot_int = 10 \
+        max_step = 200 \
+        particles.write_ascii_files = 1 \
+        particles.mass_transfer = 0 \
+        particles.use_splash_model = true \
+        particles.film_transport = 1 \
+        particles.wall_temp = 400. \
+        particles.contact_angle = 60. \
+        particles.fuel_sigma = 19.7 \
+        particles.NC7H16_mu = 0.0387 0. 0. 0.
+
+python3 check_film_mass.py ${TPD}/spray*.p3d --dim 3 --nfuel 2 --rho 0.693
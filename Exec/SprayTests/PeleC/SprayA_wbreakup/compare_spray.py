@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+# Compare the Sauter mean diameter and liquid penetration between the spray
+# ASCII files of a reference run and a test run, written at the same times
+# with particles.write_ascii_files = 1. Used by run_merge_test.sh,
+# run_tab_test.sh, the run_prec_test.sh scripts of abramzon_test and
+# jet_spray, and heptane_evap/run_compact_test.sh and run_table_test.sh; the
+# penetration is the axial distance from the nozzle that contains a fraction
+# of the liquid mass, as for the ECN Spray A data
+import argparse
+import sys
+
+parser = argparse.ArgumentParser()
+parser.add_argument("files", help="Spray ASCII files of the reference run in time order", nargs='+', type=str)
+parser.add_argument("--test", help="Spray ASCII files of the test run in time order", nargs='+', type=str, required=True)
+parser.add_argument("--dim", help="Number of dimensions", default=3, type=int)
+parser.add_argument("--nfuel", help="SPRAY_FUEL_NUM used for the build", default=1, type=int)
+parser.add_argument("--axis", help="Direction of the jet", default=2, type=int)
+parser.add_argument("--nozzle", help="Axial position of the nozzle", default=0., type=float)
+parser.add_argument("--frac", help="Liquid mass fraction within the penetration", default=0.95, type=float)
+parser.add_argument("--tol", help="Relative tolerance on d32 and the penetration", default=0.05, type=float)
+args = parser.parse_args()
+
+if (len(args.files) != len(args.test)):
+    print("FAILED: runs wrote different numbers of files")
+    sys.exit(1)
+
+# Offsets of the parcel data in each line: position, ID, CPU, then SprayComps
+rstart = args.dim + 2
+dia_indx = rstart + args.dim + 1
+numdens_indx = rstart + args.dim + 2 + args.nfuel
+film_indx = numdens_indx + 4
+num_reals = args.dim + args.nfuel + 7
+
+def spray_stats(fname):
+    num_parcels = 0
+    sum_d3 = 0.
+    sum_d2 = 0.
+    axial_mass = []
+    with open(fname) as pfile:
+        for line in pfile:
+            vals = line.split()
+            # Skip the header lines
+            if (len(vals) < rstart + num_reals):
+                continue
+            if (float(vals[film_indx]) > 0.):
+                continue
+            dia = float(vals[dia_indx])
+            num_dens = float(vals[numdens_indx])
+            num_parcels += 1
+            sum_d3 += num_dens * dia**3
+            sum_d2 += num_dens * dia**2
+            # Droplet mass up to the constant density
+            axial_mass.append((abs(float(vals[args.axis]) - args.nozzle), num_dens * dia**3))
+    d32 = sum_d3 / sum_d2 if (sum_d2 > 0.) else 0.
+    axial_mass.sort()
+    pen = 0.
+    cum_mass = 0.
+    for dist, mass in axial_mass:
+        cum_mass += mass
+        pen = dist
+        if (cum_mass >= args.frac * sum_d3):
+            break
+    return num_parcels, d32, pen
+
+def rel_diff(val, ref):
+    return abs(val - ref) / ref if (ref > 0.) else abs(val)
+
+max_err = 0.
+for fname, tname in zip(args.files, args.test):
+    num_ref, d32_ref, pen_ref = spray_stats(fname)
+    num_tst, d32_tst, pen_tst = spray_stats(tname)
+    d32_err = rel_diff(d32_tst, d32_ref)
+    pen_err = rel_diff(pen_tst, pen_ref)
+    max_err = max(max_err, d32_err, pen_err)
+    print("{}: parcels {} vs {}, d32 {:.5e} vs {:.5e} ({:.3e}), penetration {:.5e} vs {:.5e} ({:.3e})".format(
+        tname, num_tst, num_ref, d32_tst, d32_ref, d32_err, pen_tst, pen_ref, pen_err))
+if (max_err > args.tol):
+    print("FAILED: d32 or the penetration changed by {:.3e}".format(max_err))
+    sys.exit(1)
+print("PASSED")
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# Parcel merging regression: Spray A with KHRT breakup is run with and without
+# parcel merging, and the Sauter mean diameter and liquid penetration from the
+# spray ASCII files are compared between the runs
+set -e
+EXEC=${EXEC:-"./PeleC3d.gnu.TPROF.MPI.ex"}
+RUN=${RUN:-"mpiexec -n 4"}
+TPD="merge_files"
+
+for MERGE_INT in 0 5; do
+    mkdir -p ${TPD}/merge${MERGE_INT}
+    ${RUN} ${EXEC} spraya-input \
+            amr.plot_file = ${TPD}/merge${MERGE_INT}/plt \
+            amr.check_int = -1 \
+            amr.plot_per = 2.5E-4 \
+            stop_time = 5.E-4 \
+            max_step = 100000 \
+            spray.jet1.roi_file = ref/roi.dat \
+            particles.v = 1 \
+            particles.write_ascii_files = 1 \
+            particles.merge_int = ${MERGE_INT}
+done
+
+python3 compare_spray.py ${TPD}/merge0/spray*.p3d --test ${TPD}/merge5/spray*.p3d
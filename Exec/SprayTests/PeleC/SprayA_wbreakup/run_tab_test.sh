@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# TAB breakup regression: Spray A is run with TAB breakup using EXEC and
+# REF_EXEC, an executable built with the previous TAB update, and the Sauter
+# mean diameter and liquid penetration from the spray ASCII files are compared
+# between the runs
+set -e
+EXEC=${EXEC:-"./PeleC3d.gnu.TPROF.MPI.ex"}
+RUN=${RUN:-"mpiexec -n 4"}
+if [ -z "${REF_EXEC}" ]; then
+    echo "Set REF_EXEC to the reference executable"
+    exit 1
+fi
+TPD="tab_files"
+
+for CASE in ref test; do
+    CASE_EXEC=${EXEC}
+    if [ "${CASE}" == "ref" ]; then
+        CASE_EXEC=${REF_EXEC}
+    fi
+    mkdir -p ${TPD}/${CASE}
+    ${RUN} ${CASE_EXEC} spraya-input \
+            amr.plot_file = ${TPD}/${CASE}/plt \
+            amr.check_int = -1 \
+            amr.plot_per = 2.5E-4 \
+            stop_time = 5.E-4 \
+            max_step = 100000 \
+            spray.jet1.roi_file = ref/roi.dat \
+            particles.write_ascii_files = 1 \
+            particles.use_breakup_model = TAB
+done
+
+python3 compare_spray.py ${TPD}/ref/spray*.p3d --test ${TPD}/test/spray*.p3d
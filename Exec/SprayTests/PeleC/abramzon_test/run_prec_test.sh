@@ -0,0 +1,32 @@
+#!/bin/bash
+
+# Single precision parcel state: the evaporating decane droplet is run with
+# EXEC, built with USE_SPRAY_SINGLE = TRUE, and with REF_EXEC, built with
+# USE_SPRAY_SINGLE = FALSE, and the droplet diameter and position from the
+# spray ASCII files are compared between the runs, along with the run times
+set -e
+EXEC=${EXEC:-"./PeleC2d.gnu.ex"}
+RUN=${RUN:-""}
+if [ -z "${REF_EXEC}" ]; then
+    echo "Set REF_EXEC to the double precision executable"
+    exit 1
+fi
+TPD="prec_files"
+
+for CASE in ref test; do
+    CASE_EXEC=${EXEC}
+    if [ "${CASE}" == "ref" ]; then
+        CASE_EXEC=${REF_EXEC}
+    fi
+    mkdir -p ${TPD}/${CASE}
+    START=$(date +%s.%N)
+    ${RUN} ${CASE_EXEC} inputs_2d \
+            amr.plot_file = ${TPD}/${CASE}/plt \
+            particles.v = 1 > ${TPD}/${CASE}/run.log
+    END=$(date +%s.%N)
+    grep "bytes per parcel" ${TPD}/${CASE}/run.log || true
+    echo "${CASE}: $(echo "${END} - ${START}" | bc) s"
+done
+
+python3 ../SprayA_wbreakup/compare_spray.py ${TPD}/ref/spray*.p3d \
+        --test ${TPD}/test/spray*.p3d --dim 2 --axis 0 --tol 1.E-4
@@ -0,0 +1,70 @@
+#!/bin/bash
+
+# Parcel compaction benchmark: a lattice of fixed n-heptane droplets with
+# diameters from 10 to 60 microns evaporates in hot air, so parcels are
+# removed throughout the run. The case is run without compaction and with
+# each fraction in COMPACT_FRACS, with the redistribution skipped while the
+# parcels are in their tiles. The run time, the mean removed parcel fraction
+# after each update, and the compacted parcels are printed, and the spray
+# must match the run without compaction
+set -e
+EXEC=${EXEC:-"./PeleC2d.gnu.ex"}
+RUN=${RUN:-""}
+NUM_PART=${NUM_PART:-256}
+COMPACT_FRACS=${COMPACT_FRACS:-"0 0.25 0.5"}
+STOP_TIME=${STOP_TIME:-"4.E-3"}
+TPD="compact_files"
+
+# Droplets at the cell centers of a NUM_PART by NUM_PART lattice with random
+# diameters, in the ascii format of initsprayfile
+mkdir -p ${TPD}
+python3 - ${NUM_PART} ${TPD}/initsprayfile <<PYEOF
+import random
+import sys
+num_part = int(sys.argv[1])
+rng = random.Random(0)
+with open(sys.argv[2], "w") as pfile:
+    pfile.write("{}\n".format(num_part * num_part))
+    for j in range(num_part):
+        for i in range(num_part):
+            x = 50. * (i + 0.5) / num_part
+            y = 50. * (j + 0.5) / num_part
+            dia = 10.E-4 + 50.E-4 * rng.random()
+            pfile.write(
+                "{} {} 0. 0. 300. {:.6e} 1. 1. 0. 0. 0. 0.\n".format(x, y, dia))
+PYEOF
+
+for FRAC in -1 ${COMPACT_FRACS}; do
+    mkdir -p ${TPD}/compact${FRAC}
+    START=$(date +%s.%N)
+    ${RUN} ${EXEC} input2d \
+            amr.plot_file = ${TPD}/compact${FRAC}/plt \
+            amr.plot_per = ${STOP_TIME} \
+            stop_time = ${STOP_TIME} \
+            prob.init_T = 1000. \
+            particles.init_file = ${TPD}/initsprayfile \
+            particles.redist_buffer = 1 \
+            particles.compact_frac = ${FRAC} \
+            particles.stats_file = ${TPD}/compact${FRAC}/stats.csv \
+            particles.v = 1 > ${TPD}/compact${FRAC}/run.log
+    END=$(date +%s.%N)
+    python3 - ${TPD}/compact${FRAC}/stats.csv <<PYEOF
+import csv
+import sys
+with open(sys.argv[1]) as sfile:
+    rows = list(csv.DictReader(sfile))
+dead = [float(row["dead_frac"]) for row in rows]
+compacted = sum(int(row["num_compacted"]) for row in rows)
+print("compact_frac ${FRAC}: {} steps, mean removed fraction {:.3f}, "
+      "maximum {:.3f}, {} parcels compacted".format(
+          len(rows), sum(dead) / max(len(dead), 1), max(dead, default=0.),
+          compacted))
+PYEOF
+    echo "compact_frac ${FRAC}: $(echo "${END} - ${START}" | bc) s"
+done
+
+for FRAC in ${COMPACT_FRACS}; do
+    python3 ../SprayA_wbreakup/compare_spray.py ${TPD}/compact-1/spray*.p3d \
+            --test ${TPD}/compact${FRAC}/spray*.p3d --dim 2 --axis 0 \
+            --tol 1.E-12
+done
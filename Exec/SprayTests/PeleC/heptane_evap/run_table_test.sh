@@ -0,0 +1,52 @@
+#!/bin/bash
+
+# Tabulated liquid properties: the evaporating n-heptane droplet is run with
+# the density and Antoine saturation pressure fits of input2d and with a
+# table of both sampled from the fits at NUM_PTS temperatures, in the format
+# written by Util/liquidProp/propcoeff.py --table. The droplet diameter and
+# position from the spray ASCII files are compared between the runs, along
+# with the run times
+set -e
+EXEC=${EXEC:-"./PeleC2d.gnu.ex"}
+RUN=${RUN:-""}
+NUM_PTS=${NUM_PTS:-64}
+STOP_TIME=${STOP_TIME:-100.}
+PLOT_PER=${PLOT_PER:-10.}
+TPD="table_files"
+
+# The droplet starts at 272 K and the table ends at the boiling temperature
+mkdir -p ${TPD}
+python3 - ${NUM_PTS} ${TPD}/prop_table.dat <<PYEOF
+import sys
+num_pts = int(sys.argv[1])
+T_lo = 250.
+T_hi = 371.6
+with open(sys.argv[2], "w") as tfile:
+    tfile.write("# Sampled from the fits of input2d\n")
+    tfile.write("T rho psat\n")
+    for k in range(num_pts):
+        T = T_lo + (T_hi - T_lo) * k / (num_pts - 1)
+        psat = 1.E6 * 10.**(4.02832 - 1268.636 / (T - 56.199))
+        tfile.write("{:.10e} {:.10e} {:.10e}\n".format(T, 0.6814, psat))
+PYEOF
+
+for CASE in fit table; do
+    TABLE_ARGS=""
+    if [ "${CASE}" == "table" ]; then
+        TABLE_ARGS="particles.NC7H16_prop_table = ${TPD}/prop_table.dat"
+    fi
+    mkdir -p ${TPD}/${CASE}
+    START=$(date +%s.%N)
+    ${RUN} ${EXEC} input2d \
+            amr.plot_file = ${TPD}/${CASE}/plt \
+            amr.plot_per = ${PLOT_PER} \
+            stop_time = ${STOP_TIME} \
+            particles.v = 1 ${TABLE_ARGS} > ${TPD}/${CASE}/run.log
+    END=$(date +%s.%N)
+    NUM_OUT=$(grep -c "outside their" ${TPD}/${CASE}/run.log || true)
+    echo "${CASE}: ${NUM_OUT} steps evaluated the tables outside their range"
+    echo "${CASE}: $(echo "${END} - ${START}" | bc) s"
+done
+
+python3 ../SprayA_wbreakup/compare_spray.py ${TPD}/fit/spray*.p3d \
+        --test ${TPD}/table/spray*.p3d --dim 2 --axis 0 --tol 1.E-3
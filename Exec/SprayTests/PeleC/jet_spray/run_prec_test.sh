@@ -0,0 +1,37 @@
+#!/bin/bash
+
+# Single precision parcel state: the jet is run with EXEC, built with
+# USE_SPRAY_SINGLE = TRUE, and with REF_EXEC, built with
+# USE_SPRAY_SINGLE = FALSE, and the Sauter mean diameter and liquid
+# penetration from the spray ASCII files are compared between the runs, along
+# with the run times
+set -e
+EXEC=${EXEC:-"./PeleC3d.gnu.MPI.ex"}
+RUN=${RUN:-"mpiexec -n 4"}
+if [ -z "${REF_EXEC}" ]; then
+    echo "Set REF_EXEC to the double precision executable"
+    exit 1
+fi
+TPD="prec_files"
+
+for CASE in ref test; do
+    CASE_EXEC=${EXEC}
+    if [ "${CASE}" == "ref" ]; then
+        CASE_EXEC=${REF_EXEC}
+    fi
+    mkdir -p ${TPD}/${CASE}
+    START=$(date +%s.%N)
+    ${RUN} ${CASE_EXEC} inputs-2d \
+            amr.plot_file = ${TPD}/${CASE}/plt \
+            amr.check_int = -1 \
+            amr.plot_per = 5.E-4 \
+            stop_time = 2.E-3 \
+            particles.v = 1 \
+            particles.write_ascii_files = 1 > ${TPD}/${CASE}/run.log
+    END=$(date +%s.%N)
+    grep "bytes per parcel" ${TPD}/${CASE}/run.log || true
+    echo "${CASE}: $(echo "${END} - ${START}" | bc) s"
+done
+
+python3 ../SprayA_wbreakup/compare_spray.py ${TPD}/ref/spray*.p3d \
+        --test ${TPD}/test/spray*.p3d --axis 1 --tol 0.02
@@ -142,20 +142,19 @@ ThisJet::get_new_particle(
   amrex::Real& T_part,
   amrex::Real* Y_part)
 {
-  // Interpolate values from data tables
-  amrex::Real Tmean, Tstd, SMDmean, SMDstd, Umean, Ustd, dxdx;
-  int iloc = 0;
-  if (cur_radius < jet_radius_vec[0]) {
-    iloc = 0;
-  }
-  for (int i = 0; i < data_len - 1; ++i) {
-    amrex::Real x1 = jet_radius_vec[i];
-    amrex::Real x2 = jet_radius_vec[i + 1];
-    if (cur_radius > x1 && cur_radius < x2) {
-      dxdx = (cur_radius - x1) / (x2 - x1);
-      iloc = i;
-    }
-  }
+  // Interpolate values from data tables, values are held constant outside
+  // of the table
+  amrex::Real Tmean, Tstd, SMDmean, SMDstd, Umean, Ustd;
+  int iloc = static_cast<int>(
+               std::upper_bound(
+                 jet_radius_vec.begin(), jet_radius_vec.end(), cur_radius) -
+               jet_radius_vec.begin()) -
+             1;
+  iloc = amrex::max(0, amrex::min(data_len - 2, iloc));
+  amrex::Real x1 = jet_radius_vec[iloc];
+  amrex::Real x2 = jet_radius_vec[iloc + 1];
+  amrex::Real dxdx =
+    amrex::max(0., amrex::min(1., (cur_radius - x1) / (x2 - x1)));
   for (int jc = 0; jc < 3; ++jc) {
     amrex::Real y1 = mean_vals[jc][iloc];
     amrex::Real y2 = mean_vals[jc][iloc + 1];
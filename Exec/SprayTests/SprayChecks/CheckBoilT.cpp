@@ -0,0 +1,226 @@
+#include <AMReX_ParmParse.H>
+#include "mechanism.H"
+#include "PelePhysics.H"
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+// Boiling temperatures as computed before the constant factors were moved to
+// setBoilTFact, with Watson's law evaluated on every call
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
+watson_boil_temp(
+  const SprayData& fdat,
+  const GpuArray<Real, SPRAY_FUEL_NUM>& mw_fuel,
+  const Real p_fluid,
+  Real* cBoilT)
+{
+  SprayUnits SPU;
+  const Real RU = pele::physics::Constants::RU * SPU.ru_conv;
+  const Real PATM = pele::physics::Constants::PATM * SPU.pres_conv;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    const Real Hboil_ref =
+      fdat.ref_latent[spf] *
+      std::pow(
+        (fdat.critT[spf] - fdat.ref_T) / (fdat.critT[spf] - fdat.boilT[spf]),
+        -0.38);
+    cBoilT[spf] = 1. / (std::log(PATM / p_fluid) * RU /
+                          (Hboil_ref * mw_fuel[spf]) +
+                        1. / fdat.boilT[spf]);
+    cBoilT[spf] = amrex::min(fdat.critT[spf], cBoilT[spf]);
+  }
+}
+
+// Gas pressure at a parcel in a subcycle, a base pressure that varies between
+// the parcels with a small fluctuation in time
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE Real
+parcel_pres(
+  const int i,
+  const int isub,
+  const int num_parcels,
+  const Real p_lo,
+  const Real p_hi,
+  const Real p_amp)
+{
+  const Real frac = static_cast<Real>(i) / static_cast<Real>(num_parcels);
+  const Real p_base = p_lo * std::pow(p_hi / p_lo, frac);
+  return p_base * (1. + p_amp * std::sin(0.3 * static_cast<Real>(isub) + i));
+}
+
+// Boiling temperatures reused while the pressure is within p_tol of the
+// pressure they were computed at, as in updateParticles; returns the number
+// of evaluations and, if max_err is given, the largest relative error
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE int
+cached_boil_temps(
+  const SprayData& fdat,
+  const int i,
+  const int num_sub,
+  const int num_parcels,
+  const Real p_lo,
+  const Real p_hi,
+  const Real p_amp,
+  const Real p_tol,
+  Real& sum,
+  Real* max_err)
+{
+  Real p_boil = -1.;
+  Real cBoilT[SPRAY_FUEL_NUM];
+  int num_evals = 0;
+  sum = 0.;
+  for (int isub = 0; isub < num_sub; ++isub) {
+    const Real p_fluid = parcel_pres(i, isub, num_parcels, p_lo, p_hi, p_amp);
+    if (std::abs(p_fluid - p_boil) > p_tol * p_boil) {
+      fdat.calcBoilT(p_fluid, cBoilT);
+      p_boil = p_fluid;
+      num_evals++;
+    }
+    for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+      sum += cBoilT[spf];
+    }
+    if (max_err != nullptr) {
+      Real exact[SPRAY_FUEL_NUM];
+      fdat.calcBoilT(p_fluid, exact);
+      for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+        const Real err = std::abs(cBoilT[spf] - exact[spf]) / exact[spf];
+        *max_err = amrex::max(*max_err, err);
+      }
+    }
+  }
+  return num_evals;
+}
+} // namespace
+
+int
+checkBoilT()
+{
+  ParmParse pp("boil");
+  // Parcels with base pressures log spaced in p_range (atm), each with a
+  // relative pressure fluctuation p_amp over num_sub subcycles; the error
+  // bound assumes the boiling temperatures stay below critT
+  int num_parcels = 100000;
+  pp.query("num_parcels", num_parcels);
+  int num_sub = 10;
+  pp.query("num_sub", num_sub);
+  Vector<Real> p_range = {0.1, 20.};
+  pp.queryarr("p_range", p_range);
+  Real p_amp = 1.E-3;
+  pp.query("p_amp", p_amp);
+  // Values of particles.boil_p_tol to test
+  Vector<Real> p_tols = {1.E-4, 1.E-3, 1.E-2};
+  pp.queryarr("p_tol", p_tols);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const SprayData* fdat = SprayParticleContainer::getSprayData();
+  Gpu::AsyncArray<SprayData> fdat_arr(fdat, 1);
+  const SprayData* d_fdat = fdat_arr.data();
+  SprayUnits SPU;
+  auto eos = pele::physics::PhysicsType::eos();
+  Real spec_mw[NUM_SPECIES];
+  eos.molecular_weight(spec_mw);
+  GpuArray<Real, SPRAY_FUEL_NUM> mw_fuel;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    mw_fuel[spf] = spec_mw[fdat->indx[spf]] * SPU.mass_conv;
+  }
+  const Real PATM = pele::physics::Constants::PATM * SPU.pres_conv;
+  const Real p_lo = p_range[0] * PATM;
+  const Real p_hi = p_range[1] * PATM;
+
+  // Each kernel accumulates the boiling temperatures over the subcycles, as
+  // calculateSpraySource uses them
+  Gpu::DeviceVector<Real> d_old(num_parcels);
+  Gpu::DeviceVector<Real> d_new(num_parcels);
+  Real* old_ptr = d_old.data();
+  Real* new_ptr = d_new.data();
+  double t0 = spray_checks::wall_time();
+  amrex::ParallelFor(num_parcels, [=] AMREX_GPU_DEVICE(int i) noexcept {
+    Real sum = 0.;
+    for (int isub = 0; isub < num_sub; ++isub) {
+      Real cBoilT[SPRAY_FUEL_NUM];
+      watson_boil_temp(
+        *d_fdat, mw_fuel,
+        parcel_pres(i, isub, num_parcels, p_lo, p_hi, p_amp), cBoilT);
+      for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+        sum += cBoilT[spf];
+      }
+    }
+    old_ptr[i] = sum;
+  });
+  Gpu::streamSynchronize();
+  double t1 = spray_checks::wall_time();
+  amrex::ParallelFor(num_parcels, [=] AMREX_GPU_DEVICE(int i) noexcept {
+    Real sum = 0.;
+    for (int isub = 0; isub < num_sub; ++isub) {
+      Real cBoilT[SPRAY_FUEL_NUM];
+      d_fdat->calcBoilT(
+        parcel_pres(i, isub, num_parcels, p_lo, p_hi, p_amp), cBoilT);
+      for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+        sum += cBoilT[spf];
+      }
+    }
+    new_ptr[i] = sum;
+  });
+  Gpu::streamSynchronize();
+  double t2 = spray_checks::wall_time();
+  const double ns = 1.E9 / (static_cast<double>(num_parcels) * num_sub);
+  const Real max_fact_diff = Reduce::Max<Real>(
+    num_parcels, [=] AMREX_GPU_DEVICE(int i) noexcept -> Real {
+      return std::abs(new_ptr[i] - old_ptr[i]) / old_ptr[i];
+    });
+  amrex::Print() << "  Watson's law on every call " << (t1 - t0) * ns
+                 << " ns, precomputed factors " << (t2 - t1) * ns
+                 << " ns per parcel and subcycle\n";
+  int num_fail = 0;
+  num_fail += spray_checks::report(
+    "precomputed factors match Watson's law, maximum relative difference " +
+      std::to_string(max_fact_diff),
+    max_fact_diff <= 1.E-12);
+
+  // Reuse the boiling temperatures while the pressure is within the
+  // tolerance, as in updateParticles; the relative error is bounded by
+  // critT boilT_fact log(1 / (1 - p_tol))
+  Real max_fact = 0.;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    max_fact = amrex::max(max_fact, fdat->critT[spf] * fdat->boilT_fact[spf]);
+  }
+  Gpu::DeviceVector<Real> d_err(num_parcels);
+  Gpu::DeviceVector<int> d_evals(num_parcels);
+  Real* err_ptr = d_err.data();
+  int* evals_ptr = d_evals.data();
+  for (const Real p_tol : p_tols) {
+    double t3 = spray_checks::wall_time();
+    amrex::ParallelFor(num_parcels, [=] AMREX_GPU_DEVICE(int i) noexcept {
+      evals_ptr[i] = cached_boil_temps(
+        *d_fdat, i, num_sub, num_parcels, p_lo, p_hi, p_amp, p_tol,
+        new_ptr[i], nullptr);
+    });
+    Gpu::streamSynchronize();
+    double t4 = spray_checks::wall_time();
+    amrex::ParallelFor(num_parcels, [=] AMREX_GPU_DEVICE(int i) noexcept {
+      Real sum = 0.;
+      err_ptr[i] = 0.;
+      cached_boil_temps(
+        *d_fdat, i, num_sub, num_parcels, p_lo, p_hi, p_amp, p_tol, sum,
+        &err_ptr[i]);
+    });
+    Gpu::streamSynchronize();
+    const Real max_err = Reduce::Max<Real>(
+      num_parcels,
+      [=] AMREX_GPU_DEVICE(int i) noexcept -> Real { return err_ptr[i]; });
+    const Long num_evals = Reduce::Sum<Long>(
+      num_parcels,
+      [=] AMREX_GPU_DEVICE(int i) noexcept -> Long { return evals_ptr[i]; });
+    const Real err_bound = max_fact * -std::log1p(-p_tol);
+    amrex::Print() << "  boil_p_tol " << p_tol << ": "
+                   << static_cast<double>(num_evals) /
+                        (static_cast<double>(num_parcels) * num_sub)
+                   << " of the subcycles evaluate calcBoilT, maximum relative "
+                   << "error " << max_err << ", bound " << err_bound
+                   << ", " << (t4 - t3) * ns << " ns\n";
+    num_fail += spray_checks::report(
+      "boil_p_tol " + std::to_string(p_tol) + " error within its bound",
+      max_err <= err_bound * (1. + 1.E-10));
+  }
+  return num_fail;
+}
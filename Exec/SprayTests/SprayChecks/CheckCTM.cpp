@@ -0,0 +1,252 @@
+#include <AMReX_ParmParse.H>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+// Continuous thermodynamics parameters with molar masses in g/mol, the lump
+// bounds evenly spaced between gamma and theta + 3 sigma
+CTMData
+make_ctm(
+  const Real gamma,
+  const Real theta,
+  const Real sigma,
+  const Real tb_a,
+  const Real tb_b)
+{
+  SprayUnits SPU;
+  CTMData ctm;
+  ctm.gamma = gamma * SPU.mass_conv;
+  ctm.tb_a = tb_a;
+  ctm.tb_b = tb_b / SPU.mass_conv;
+  ctm.theta0 = theta * SPU.mass_conv;
+  const Real sig = sigma * SPU.mass_conv;
+  ctm.psi0 = ctm.theta0 * ctm.theta0 + sig * sig;
+  ctm.limitMoments(ctm.theta0, ctm.psi0);
+  const Real bnd_hi = (theta + 3. * sigma) * SPU.mass_conv;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM - 1; ++spf) {
+    ctm.lump_bnd[spf] = ctm.gamma + (bnd_hi - ctm.gamma) * (spf + 1.) /
+                                      static_cast<Real>(SPRAY_FUEL_NUM);
+  }
+  ctm.massFrac(ctm.theta0, ctm.psi0, ctm.Y0.data());
+  return ctm;
+}
+
+// Shape parameter and argument of the incomplete Gamma function for sample i
+// of an n by n grid, log spaced in a_range and in x / a from 1E-3 to 1E3
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE void
+gamma_args(
+  const int i, const int n, const Real a_lo, const Real a_hi, Real& a, Real& x)
+{
+  const Real fa = static_cast<Real>(i / n) / static_cast<Real>(n - 1);
+  const Real fx = static_cast<Real>(i % n) / static_cast<Real>(n - 1);
+  a = a_lo * std::pow(a_hi / a_lo, fa);
+  x = a * std::pow(10., 6. * fx - 3.);
+}
+
+// Moments of parcel i, with the standard deviation varying between 0.5 and
+// 1.5 times that of the initial distribution
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE void
+parcel_moments(
+  const CTMData& ctm,
+  const int i,
+  const int num_parcels,
+  Real& theta,
+  Real& psi)
+{
+  const Real frac = static_cast<Real>(i) / static_cast<Real>(num_parcels);
+  const Real var = (ctm.psi0 - ctm.theta0 * ctm.theta0) *
+                   (0.25 + 2. * frac * frac);
+  theta = ctm.theta0;
+  psi = theta * theta + var;
+  ctm.limitMoments(theta, psi);
+}
+} // namespace
+
+int
+checkCTM()
+{
+  ParmParse pp("ctm");
+  // Initial distribution, in g/mol, and boiling temperature line
+  Real gamma = 72.;
+  pp.query("gamma", gamma);
+  Real theta = 100.2;
+  pp.query("theta", theta);
+  Real sigma = 5.;
+  pp.query("sigma", sigma);
+  Real tb_a = 241.4;
+  pp.query("tb_a", tb_a);
+  Real tb_b = 1.2994;
+  pp.query("tb_b", tb_b);
+  // Droplet temperature and fraction of the mass evaporated in each step
+  Real T_part = 350.;
+  pp.query("T", T_part);
+  Real evap_frac = 0.05;
+  pp.query("evap_frac", evap_frac);
+  int num_steps = 50;
+  pp.query("num_steps", num_steps);
+  // Samples of P(a, x) in each direction, and the range of a
+  int num_gamma = 200;
+  pp.query("num_gamma", num_gamma);
+  Vector<Real> a_range = {0.5, 400.};
+  pp.queryarr("alpha_range", a_range);
+  Real tol = 1.E-10;
+  pp.query("tol", tol);
+  // Parcels and substeps for the timings
+  int num_parcels = 100000;
+  pp.query("num_parcels", num_parcels);
+  int num_sub = 10;
+  pp.query("num_sub", num_sub);
+  // Numbers of fuel components for the storage comparison
+  Vector<int> num_comps = {1, 10, 50};
+  pp.queryarr("num_comp", num_comps);
+
+  const CTMData ctm = make_ctm(gamma, theta, sigma, tb_a, tb_b);
+  int num_fail = 0;
+
+  // P(a + 1, x) from the recurrence used by massFrac against a direct
+  // evaluation, and the time of both
+  const int num_samp = num_gamma * num_gamma;
+  const Real a_lo = a_range[0];
+  const Real a_hi = a_range[1];
+  Gpu::DeviceVector<Real> d_rec(num_samp);
+  Gpu::DeviceVector<Real> d_dir(num_samp);
+  Real* rec_ptr = d_rec.data();
+  Real* dir_ptr = d_dir.data();
+  double t0 = spray_checks::wall_time();
+  amrex::ParallelFor(num_samp, [=] AMREX_GPU_DEVICE(int i) noexcept {
+    Real a, x;
+    gamma_args(i, num_gamma, a_lo, a_hi, a, x);
+    Real pref = 0.;
+    const Real P0 = ctmIncGammaP(a, x, std::lgamma(a), &pref);
+    rec_ptr[i] = amrex::max(0., P0 - pref / a);
+  });
+  Gpu::streamSynchronize();
+  double t1 = spray_checks::wall_time();
+  amrex::ParallelFor(num_samp, [=] AMREX_GPU_DEVICE(int i) noexcept {
+    Real a, x;
+    gamma_args(i, num_gamma, a_lo, a_hi, a, x);
+    ctmIncGammaP(a, x, std::lgamma(a));
+    dir_ptr[i] = ctmIncGammaP(a + 1., x, std::lgamma(a + 1.));
+  });
+  Gpu::streamSynchronize();
+  double t2 = spray_checks::wall_time();
+  const Real max_rec_diff = Reduce::Max<Real>(
+    num_samp, [=] AMREX_GPU_DEVICE(int i) noexcept -> Real {
+      return std::abs(rec_ptr[i] - dir_ptr[i]);
+    });
+  const double ns_samp = 1.E9 / static_cast<double>(num_samp);
+  amrex::Print() << "  P(a, x) and P(a + 1, x) for each lump bound: "
+                 << "recurrence " << (t1 - t0) * ns_samp << " ns, two "
+                 << "evaluations " << (t2 - t1) * ns_samp << " ns\n";
+  num_fail += spray_checks::report(
+    "P(a + 1, x) recurrence matches a direct evaluation, maximum difference " +
+      std::to_string(max_rec_diff),
+    max_rec_diff <= tol);
+
+  // The lump mass fractions of the liquid and the lump fractions of the vapor
+  // must each sum to one
+  SprayUnits SPU;
+  const Real p_ratio = 1.;
+  CTMVapor vap;
+  ctm.vaporState(T_part, p_ratio, ctm.theta0, ctm.psi0, vap);
+  Real sum_Y = 0.;
+  Real sum_vap = 0.;
+  amrex::Print() << "  lump mass fractions";
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    amrex::Print() << " " << ctm.Y0[spf];
+    sum_Y += ctm.Y0[spf];
+    sum_vap += vap.lump_frac[spf];
+  }
+  amrex::Print() << ", surface vapor mole fraction " << vap.X_vap
+                 << " with mean molar mass " << vap.theta_V / SPU.mass_conv
+                 << " g/mol\n";
+  num_fail += spray_checks::report(
+    "lump mass fractions and vapor lump fractions sum to one",
+    std::abs(sum_Y - 1.) <= tol && std::abs(sum_vap - 1.) <= tol);
+
+  // Evaporate a droplet in steps; each step must remove the moles of the
+  // vapor, and the mean molar mass of the liquid must grow as the lighter
+  // components leave first
+  Real mass = 1.;
+  Real cur_theta = ctm.theta0;
+  Real cur_psi = ctm.psi0;
+  Real max_mol_err = 0.;
+  bool heavier = true;
+  bool valid = true;
+  for (int step = 0; step < num_steps; ++step) {
+    ctm.vaporState(T_part, p_ratio, cur_theta, cur_psi, vap);
+    const Real new_mass = mass * (1. - evap_frac);
+    const Real mol_exp = mass / cur_theta - (mass - new_mass) / vap.theta_V;
+    const Real old_theta = cur_theta;
+    ctm.evapMoments(mass, new_mass, vap, cur_theta, cur_psi);
+    max_mol_err = amrex::max(
+      max_mol_err, std::abs(new_mass / cur_theta - mol_exp) / mol_exp);
+    heavier = heavier && cur_theta >= old_theta;
+    valid = valid && cur_psi >= cur_theta * cur_theta && cur_theta > ctm.gamma;
+    mass = new_mass;
+  }
+  amrex::Print() << "  after evaporating " << 100. * (1. - mass)
+                 << "% of the liquid at " << T_part << " K the mean molar "
+                 << "mass is " << cur_theta / SPU.mass_conv << " g/mol with "
+                 << "standard deviation "
+                 << std::sqrt(cur_psi - cur_theta * cur_theta) / SPU.mass_conv
+                 << " g/mol\n";
+  num_fail += spray_checks::report(
+    "evaporation conserves the liquid moles, maximum relative error " +
+      std::to_string(max_mol_err),
+    max_mol_err <= tol);
+  num_fail += spray_checks::report(
+    "mean molar mass grows and the distribution stays valid",
+    heavier && valid);
+
+  // Cost of the composition of each parcel in each substep, the lump mass
+  // fractions from the moments and the surface vapor
+  Gpu::DeviceVector<Real> d_sum(num_parcels);
+  Real* sum_ptr = d_sum.data();
+  double t3 = spray_checks::wall_time();
+  amrex::ParallelFor(num_parcels, [=] AMREX_GPU_DEVICE(int i) noexcept {
+    Real p_theta, p_psi;
+    parcel_moments(ctm, i, num_parcels, p_theta, p_psi);
+    Real sum = 0.;
+    for (int isub = 0; isub < num_sub; ++isub) {
+      Real Y_part[SPRAY_FUEL_NUM];
+      CTMVapor p_vap;
+      ctm.massFrac(p_theta, p_psi, Y_part);
+      ctm.vaporState(T_part + isub, p_ratio, p_theta, p_psi, p_vap);
+      for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+        sum += Y_part[spf] + p_vap.lump_frac[spf];
+      }
+    }
+    sum_ptr[i] = sum;
+  });
+  Gpu::streamSynchronize();
+  double t4 = spray_checks::wall_time();
+  amrex::Print() << "  lump mass fractions and vapor state "
+                 << 1.E9 * (t4 - t3) /
+                      (static_cast<double>(num_parcels) * num_sub)
+                 << " ns per parcel and substep with " << SPRAY_FUEL_NUM
+                 << " lumps\n";
+
+  // Parcel storage with one mass fraction per component and with the two
+  // moments
+#ifdef SPRAY_USE_CTM
+  const int comp_slots = 2;
+#else
+  const int comp_slots = SPRAY_FUEL_NUM;
+#endif
+  const auto real_size = static_cast<int>(sizeof(Real));
+  const int base_bytes =
+    static_cast<int>(sizeof(SprayParticleContainer::ParticleType)) -
+    comp_slots * real_size;
+  amrex::Print() << "  bytes per parcel in this build "
+                 << sizeof(SprayParticleContainer::ParticleType);
+  for (const int num_comp : num_comps) {
+    amrex::Print() << "; " << num_comp << " components: "
+                   << base_bytes + num_comp * real_size << " discrete, "
+                   << base_bytes + 2 * real_size << " continuous";
+  }
+  amrex::Print() << '\n';
+  return num_fail;
+}
@@ -0,0 +1,129 @@
+#include <AMReX_ParmParse.H>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+int
+checkCollision()
+{
+  ParmParse pp("collide");
+  // Collector and collected droplet diameters and the relative velocity
+  Real dia1 = 50.E-4;
+  pp.query("dia1", dia1);
+  Real dia2 = 20.E-4;
+  pp.query("dia2", dia2);
+  Real rel_vel = 1.E3;
+  pp.query("rel_vel", rel_vel);
+  // Mean number of collisions of a collector droplet in each step
+  Real mean_coll = 0.5;
+  pp.query("mean_coll", mean_coll);
+  // Number of collision steps, each with new parcels and random numbers
+  int num_steps = 4;
+  pp.query("num_steps", num_steps);
+  // Number of standard errors allowed for the collision fractions
+  Real num_sigma = 5.;
+  pp.query("num_sigma", num_sigma);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const Geometry& geom = amr.Geom(0);
+  const SprayData* fdat = SprayParticleContainer::getSprayData();
+  if (!fdat->do_collision) {
+    amrex::Abort("collide check requires particles.use_collision_model = 1");
+  }
+  const Real T_part = 300.;
+  const Real Y_part[SPRAY_FUEL_NUM] = {1.};
+  Real rho_part = 0.;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    rho_part += Y_part[spf] / fdat->rhoL(T_part, spf);
+  }
+  rho_part = 1. / rho_part;
+  const Real cell_vol = AMREX_D_TERM(
+    geom.CellSize(0), *geom.CellSize(1), *geom.CellSize(2));
+  const Real rad_sum = 0.5 * (dia1 + dia2);
+  const Real dt = 1.E-5;
+  // Number of collected droplets in each parcel that gives mean_coll
+  const Real num2 =
+    mean_coll * cell_vol / (M_PI * rad_sum * rad_sum * rel_vel * dt);
+  // Fraction of collisions that coalesce, from the critical impact parameter
+  const Real We = rho_part * rel_vel * rel_vel * 0.5 * dia2 / fdat->sigma;
+  const Real gamma = dia1 / dia2;
+  const Real fgamma = gamma * (gamma * (gamma - 2.4) + 2.7);
+  const Real exact_coal = amrex::min(1., 2.4 * fgamma / We);
+  const Real exact_coll = 1. - std::exp(-mean_coll);
+
+  const IntVect num_cells = geom.Domain().length();
+  int num_fail = 0;
+  for (int step = 0; step < num_steps; ++step) {
+    // One collector parcel at rest and one collected parcel in each cell,
+    // so the collision probability of each pair is independent
+    spc->clearParticles();
+    spc->uniformSprayInit(
+      num_cells, RealVect::TheZeroVector(), dia1, T_part, Y_part, 0, 1, 1.);
+    spc->uniformSprayInit(
+      num_cells, RealVect(AMREX_D_DECL(rel_vel, 0., 0.)), dia2, T_part,
+      Y_part, 0, 1, num2);
+    double t0 = spray_checks::wall_time();
+    spc->collideParcels(0, dt, step);
+    Gpu::streamSynchronize();
+    double t1 = spray_checks::wall_time();
+
+    // Collectors that have grown coalesced and those that only moved grazed
+    using PType = SprayParticleContainer::ParticleType;
+    ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+    ReduceData<Long, Long, Long> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    const Real dia_split = 0.5 * (dia1 + dia2);
+    for (MyParIter pti(*spc, 0); pti.isValid(); ++pti) {
+      const PType* pstruct = pti.GetArrayOfStructs().data();
+      reduce_op.eval(
+        pti.numParticles(), reduce_data,
+        [=] AMREX_GPU_DEVICE(const int i) -> ReduceTuple {
+          const PType& p = pstruct[i];
+          const Real dia = parcelState(p, SprayComps::pstateDia);
+          if (p.id() <= 0 || dia < dia_split) {
+            return {0, 0, 0};
+          }
+          Real vel_mag = 0.;
+          for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            vel_mag += std::abs(parcelState(p, SprayComps::pstateVel + dir));
+          }
+          const Long coal = (dia > dia1) ? 1 : 0;
+          const Long graze = (coal == 0 && vel_mag > 0.) ? 1 : 0;
+          return {1, graze, coal};
+        });
+    }
+    ReduceTuple hv = reduce_data.value();
+    Long num_pairs = amrex::get<0>(hv);
+    Long num_graze = amrex::get<1>(hv);
+    Long num_coal = amrex::get<2>(hv);
+    ParallelDescriptor::ReduceLongSum(num_pairs);
+    ParallelDescriptor::ReduceLongSum(num_graze);
+    ParallelDescriptor::ReduceLongSum(num_coal);
+    const Real np = static_cast<Real>(num_pairs);
+    const Real coll_frac = static_cast<Real>(num_graze + num_coal) / np;
+    const Real err_coll =
+      num_sigma * std::sqrt(exact_coll * (1. - exact_coll) / np);
+    const Real num_coll = static_cast<Real>(num_graze + num_coal);
+    const Real coal_frac =
+      (num_coll > 0.) ? static_cast<Real>(num_coal) / num_coll : 0.;
+    const Real err_coal = num_sigma * std::sqrt(
+                                        exact_coal * (1. - exact_coal) /
+                                        amrex::max(num_coll, 1.));
+    amrex::Print() << "  step " << step << ": " << num_pairs << " pairs, "
+                   << num_graze << " grazing, " << num_coal
+                   << " coalescing, " << 1.E9 * (t1 - t0) / (2. * np)
+                   << " ns/parcel\n";
+    num_fail += spray_checks::report(
+      "step " + std::to_string(step) + " collision fraction " +
+        std::to_string(coll_frac) + " vs " + std::to_string(exact_coll),
+      num_pairs > 0 && std::abs(coll_frac - exact_coll) <= err_coll);
+    num_fail += spray_checks::report(
+      "step " + std::to_string(step) + " coalescence fraction " +
+        std::to_string(coal_frac) + " vs " + std::to_string(exact_coal),
+      std::abs(coal_frac - exact_coal) <= err_coal);
+  }
+  spc->clearParticles();
+  return num_fail;
+}
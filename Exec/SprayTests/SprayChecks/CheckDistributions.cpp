@@ -0,0 +1,222 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Random.H>
+#include <AMReX_GpuContainers.H>
+#include <algorithm>
+#include <cmath>
+#include "SprayChecks.H"
+#include "Distributions.H"
+
+using namespace amrex;
+
+namespace {
+struct DistCase
+{
+  std::string type;
+  DistKind kind;
+  Real p0;
+  Real p1;
+};
+
+// Exact CDF of the distributions, with the parameters of DistQuantile::eval()
+Real
+exact_cdf(const DistCase& dc, const Real& dia)
+{
+  switch (dc.kind) {
+  case DistKind::Normal:
+    return 0.5 * std::erfc(-(dia - dc.p0) / (dc.p1 * std::sqrt(2.)));
+  case DistKind::LogNormal:
+    if (dia <= 0.) {
+      return 0.;
+    }
+    return 0.5 * std::erfc(-(std::log(dia) - dc.p0) / (dc.p1 * std::sqrt(2.)));
+  case DistKind::Weibull:
+    if (dia <= 0.) {
+      return 0.;
+    }
+    return 1. - std::exp(-std::pow(dia / dc.p0, dc.p1));
+  case DistKind::ChiSquared:
+    return DistQuantile::chi_squared_cdf(
+      amrex::min(12., amrex::max(0., 3. * dia / dc.p0)));
+  default:
+    return (dia < dc.p0) ? 0. : 1.;
+  }
+}
+
+// Kolmogorov-Smirnov statistic of the samples against the exact CDF
+Real
+ks_statistic(const DistCase& dc, Vector<Real>& samples)
+{
+  std::sort(samples.begin(), samples.end());
+  const Real ns = static_cast<Real>(samples.size());
+  Real dmax = 0.;
+  for (int i = 0; i < static_cast<int>(samples.size()); ++i) {
+    const Real cdf = exact_cdf(dc, samples[i]);
+    dmax = amrex::max(
+      dmax, amrex::max(
+              cdf - static_cast<Real>(i) / ns,
+              static_cast<Real>(i + 1) / ns - cdf));
+  }
+  return dmax;
+}
+
+// Compare the first two moments and the KS statistic of the samples with the
+// exact distribution, and check that the tails beyond the table are sampled
+int
+check_samples(
+  const std::string& label,
+  const DistCase& dc,
+  const int table_size,
+  Vector<Real>& samples,
+  const Real ks_crit,
+  const Real num_sigma)
+{
+  // Exact moments from the midpoint rule over the inverse CDF
+  const int nquad = 200000;
+  Real exact_m1 = 0.;
+  Real exact_m2 = 0.;
+  for (int i = 0; i < nquad; ++i) {
+    const Real rand = (static_cast<Real>(i) + 0.5) / static_cast<Real>(nquad);
+    const Real dia = DistQuantile::eval(dc.kind, dc.p0, dc.p1, rand);
+    exact_m1 += dia / static_cast<Real>(nquad);
+    exact_m2 += dia * dia / static_cast<Real>(nquad);
+  }
+  const Real ns = static_cast<Real>(samples.size());
+  Real m1 = 0.;
+  Real m2 = 0.;
+  Real m4 = 0.;
+  for (const Real dia : samples) {
+    m1 += dia / ns;
+    m2 += dia * dia / ns;
+    m4 += std::pow(dia, 4) / ns;
+  }
+  // Standard errors of the sample moments
+  const Real err_m1 =
+    num_sigma * std::sqrt(amrex::max(0., m2 - m1 * m1) / ns);
+  const Real err_m2 =
+    num_sigma * std::sqrt(amrex::max(0., m4 - m2 * m2) / ns);
+  int num_fail = 0;
+  num_fail += spray_checks::report(
+    label + " mean " + std::to_string(m1) + " vs " + std::to_string(exact_m1),
+    std::abs(m1 - exact_m1) <= err_m1);
+  num_fail += spray_checks::report(
+    label + " second moment " + std::to_string(m2) + " vs " +
+      std::to_string(exact_m2),
+    std::abs(m2 - exact_m2) <= err_m2);
+  if (table_size > 0) {
+    // Fraction of samples beyond the last table entry, which a truncated
+    // table never produces
+    const Real rmax = static_cast<Real>(table_size) /
+                      static_cast<Real>(table_size + 1);
+    const Real dmax = DistQuantile::eval(dc.kind, dc.p0, dc.p1, rmax);
+    Real frac = 0.;
+    for (const Real dia : samples) {
+      frac += (dia > dmax) ? 1. / ns : 0.;
+    }
+    const Real exact_frac = 1. - rmax;
+    const Real err_frac =
+      num_sigma * std::sqrt(exact_frac * (1. - exact_frac) / ns);
+    num_fail += spray_checks::report(
+      label + " upper tail fraction " + std::to_string(frac) + " vs " +
+        std::to_string(exact_frac),
+      std::abs(frac - exact_frac) <= err_frac);
+  }
+  const Real ks = ks_statistic(dc, samples);
+  num_fail += spray_checks::report(
+    label + " KS statistic " + std::to_string(ks) + " < " +
+      std::to_string(ks_crit),
+    ks < ks_crit);
+  return num_fail;
+}
+} // namespace
+
+int
+checkDistributions()
+{
+  ParmParse pp("dist");
+  int num_samples = 100000;
+  pp.query("num_samples", num_samples);
+  Vector<int> table_sizes = {0, 64, 1024};
+  pp.queryarr("table_sizes", table_sizes);
+  // Number of standard errors allowed for the moments and tail fractions
+  Real num_sigma = 5.;
+  pp.query("num_sigma", num_sigma);
+  // KS critical value for a significance level of 0.001
+  const Real ks_crit = 1.95 / std::sqrt(static_cast<Real>(num_samples));
+
+  const Real mean = 50.E-4;
+  const Real std_dev = 15.E-4;
+  const Real log_mean =
+    2. * std::log(mean) - 0.5 * std::log(std_dev * std_dev + mean * mean);
+  const Real log_std =
+    std::sqrt(-2. * std::log(mean) + std::log(std_dev * std_dev + mean * mean));
+  const Vector<DistCase> cases = {
+    {"Normal", DistKind::Normal, mean, std_dev},
+    {"LogNormal", DistKind::LogNormal, log_mean, log_std},
+    {"Weibull", DistKind::Weibull, mean, 3.},
+    {"ChiSquared", DistKind::ChiSquared, mean, 0.}};
+
+  amrex::InitRandom(1234);
+  int num_fail = 0;
+  for (const auto& dc : cases) {
+    for (const int table_size : table_sizes) {
+      const std::string prefix =
+        "dist_check." + dc.type + std::to_string(table_size);
+      ParmParse ppd(prefix);
+      if (dc.kind == DistKind::ChiSquared) {
+        ppd.add("d32", mean);
+      } else if (dc.kind == DistKind::Weibull) {
+        ppd.add("mean_dia", mean);
+        ppd.add("k", dc.p1);
+      } else {
+        ppd.add("mean_dia", mean);
+        ppd.add("std_dev", std_dev);
+      }
+      ppd.add("dist_table_size", table_size);
+      std::unique_ptr<DistBase> dist = DistBase::create(dc.type);
+      dist->init(prefix);
+      const std::string label =
+        dc.type + ", table size " + std::to_string(table_size);
+
+      Vector<Real> samples(num_samples);
+      double t0 = spray_checks::wall_time();
+      for (auto& dia : samples) {
+        dia = dist->get_dia();
+      }
+      double t1 = spray_checks::wall_time();
+      amrex::Print() << "  " << label << ": "
+                     << 1.E9 * (t1 - t0) / static_cast<double>(num_samples)
+                     << " ns/sample on the host\n";
+      if (table_size == 0 && dc.kind == DistKind::ChiSquared) {
+        // Without a table, the diameters are the lower edges of 100 bins of
+        // the CDF, so only the first moment is close to the exact one
+        Real m1 = 0.;
+        for (const Real dia : samples) {
+          m1 += dia / static_cast<Real>(num_samples);
+        }
+        amrex::Print() << "  " << label << " mean " << m1
+                       << " from the binned CDF\n";
+      } else {
+        num_fail += check_samples(
+          label + " host", dc, table_size, samples, ks_crit, num_sigma);
+      }
+
+      if (dist->has_table()) {
+        // Sample the same table on the device
+        const DistSampler sampler = dist->sampler();
+        Gpu::DeviceVector<Real> d_samples(num_samples);
+        Real* sp = d_samples.data();
+        amrex::ParallelForRNG(
+          num_samples, [=] AMREX_GPU_DEVICE(
+                         int i, amrex::RandomEngine const& engine) noexcept {
+            sp[i] = sampler.sample(amrex::Random(engine));
+          });
+        Gpu::copy(
+          Gpu::deviceToHost, d_samples.begin(), d_samples.end(),
+          samples.begin());
+        num_fail += check_samples(
+          label + " device", dc, table_size, samples, ks_crit, num_sigma);
+      }
+    }
+  }
+  return num_fail;
+}
@@ -0,0 +1,280 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_GpuContainers.H>
+#include "SprayChecks.H"
+#include "SprayParticles.H"
+#include "Drag.H"
+
+using namespace amrex;
+
+namespace {
+const int max_iter = 100;
+
+// The fixed point iteration used by calcHeatCoeff before the bracketed
+// secant solver, started from the Nusselt number Nu_0 every call
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE Real
+fixed_point_heat_coeff(
+  const Real ratio,
+  const Real B_M,
+  const Real B_eps,
+  const Real C_eps,
+  const Real Nu_0,
+  int& num_iter)
+{
+  num_iter = 0;
+  if (B_M <= C_eps) {
+    return 0.;
+  }
+  const Real NU2 = Nu_0 - 2.;
+  const Real BM1 = 1. + B_M;
+  Real phi = ratio / Nu_0;
+  Real B_T_old = std::pow(BM1, phi) - 1.;
+  Real logB = std::log1p(B_T_old);
+  Real invFT = B_T_old / (logB * std::pow(1. + B_T_old, 0.7));
+  Real Nu_num = 2. + NU2 * invFT;
+  phi = ratio / Nu_num;
+  Real B_T = std::pow(BM1, phi) - 1.;
+  Real error = std::abs(B_T - B_T_old);
+  while (num_iter < max_iter && error > B_eps) {
+    B_T_old = B_T;
+    logB = std::log1p(B_T);
+    invFT = B_T / (logB * std::pow(1. + B_T, 0.7));
+    Nu_num = 2. + NU2 * invFT;
+    phi = ratio / Nu_num;
+    B_T = std::pow(BM1, phi) - 1.;
+    error = std::abs(B_T - B_T_old);
+    num_iter++;
+  }
+  logB = std::log1p(B_T);
+  invFT = B_T / (logB * std::pow(1. + B_T, 0.7));
+  Nu_num = 2. + NU2 * invFT;
+  return Nu_num * logB / B_T;
+}
+
+// Bisection for x = log(1 + B_T) between 0 and the value for a Nusselt
+// number of 2, used as the reference where the fixed point iteration fails
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE Real
+bisect_heat_coeff(
+  const Real ratio, const Real B_M, const Real C_eps, const Real Nu_0)
+{
+  if (B_M <= C_eps) {
+    return 0.;
+  }
+  const Real xm = ratio * std::log1p(B_M);
+  auto calc_nu = [=](const Real x) {
+    return 2. + (Nu_0 - 2.) * std::expm1(x) / (x * std::exp(0.7 * x));
+  };
+  Real x_lo = 0.;
+  Real x_hi = 0.5 * xm;
+  for (int n = 0; n < 200; ++n) {
+    const Real x = 0.5 * (x_lo + x_hi);
+    if (x * calc_nu(x) < xm) {
+      x_lo = x;
+    } else {
+      x_hi = x;
+    }
+  }
+  const Real x = 0.5 * (x_lo + x_hi);
+  return calc_nu(x) * x / std::expm1(x);
+}
+
+// Histogram of the iteration counts, with single counts up to 9 followed by
+// wider bins and a bin for the iterations that did not converge
+const Vector<int> hist_edges = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 20, 50};
+
+Vector<Long>
+iter_hist(const Vector<int>& iters)
+{
+  Vector<Long> hist(hist_edges.size() + 1, 0);
+  for (const int it : iters) {
+    if (it >= max_iter) {
+      hist.back()++;
+      continue;
+    }
+    int b = static_cast<int>(hist_edges.size()) - 1;
+    while (it < hist_edges[b]) {
+      b--;
+    }
+    hist[b]++;
+  }
+  return hist;
+}
+
+std::string
+hist_label(const int b)
+{
+  if (b == static_cast<int>(hist_edges.size())) {
+    return std::to_string(max_iter) + " (not converged)";
+  }
+  const int lo = hist_edges[b];
+  const int hi = (b + 1 < static_cast<int>(hist_edges.size()))
+                   ? hist_edges[b + 1] - 1
+                   : max_iter - 1;
+  return (lo == hi) ? std::to_string(lo)
+                    : std::to_string(lo) + "-" + std::to_string(hi);
+}
+} // namespace
+
+int
+checkHeatCoeff()
+{
+  ParmParse pp("heat");
+  // Log spaced samples of the ratio and B_M, for each Nusselt number Nu_0
+  int num_ratio = 200;
+  pp.query("num_ratio", num_ratio);
+  int num_bm = 200;
+  pp.query("num_bm", num_bm);
+  Vector<Real> ratio_range = {1.E-3, 30.};
+  pp.queryarr("ratio_range", ratio_range);
+  Vector<Real> bm_range = {1.E-14, 20.};
+  pp.queryarr("bm_range", bm_range);
+  Vector<Real> nu0_vals = {2.5, 5., 20.};
+  pp.queryarr("nu0", nu0_vals);
+  // Relative change of B_M from the previous substep for the warm start
+  Real warm_pert = 0.01;
+  pp.query("warm_pert", warm_pert);
+  Real tol = 1.E-6;
+  pp.query("tol", tol);
+  // Tolerances used in calculateSpraySource
+  const Real B_eps = 1.E-7;
+  const Real C_eps = 1.E-15;
+
+  const int num_nu0 = static_cast<int>(nu0_vals.size());
+  const int num_pts = num_ratio * num_bm * num_nu0;
+  Gpu::DeviceVector<Real> d_nu0(num_nu0);
+  Gpu::copy(Gpu::hostToDevice, nu0_vals.begin(), nu0_vals.end(), d_nu0.begin());
+  const Real* nu0_ptr = d_nu0.data();
+  const Real lr0 = std::log(ratio_range[0]);
+  const Real dlr =
+    (std::log(ratio_range[1]) - lr0) / static_cast<Real>(num_ratio - 1);
+  const Real lb0 = std::log(bm_range[0]);
+  const Real dlb =
+    (std::log(bm_range[1]) - lb0) / static_cast<Real>(num_bm - 1);
+  auto sample = [=] AMREX_GPU_DEVICE(
+                  const int n, Real& ratio, Real& B_M, Real& Nu_0) noexcept {
+    const int ir = n % num_ratio;
+    const int ib = (n / num_ratio) % num_bm;
+    ratio = std::exp(lr0 + static_cast<Real>(ir) * dlr);
+    B_M = std::exp(lb0 + static_cast<Real>(ib) * dlb);
+    Nu_0 = nu0_ptr[n / (num_ratio * num_bm)];
+  };
+
+  Gpu::DeviceVector<Real> d_old(num_pts);
+  Gpu::DeviceVector<Real> d_new(num_pts);
+  Gpu::DeviceVector<Real> d_ref(num_pts);
+  Gpu::DeviceVector<int> d_old_iter(num_pts);
+  Gpu::DeviceVector<int> d_cold_iter(num_pts);
+  Gpu::DeviceVector<int> d_warm_iter(num_pts);
+  Real* old_ptr = d_old.data();
+  Real* new_ptr = d_new.data();
+  Real* ref_ptr = d_ref.data();
+  int* old_iter = d_old_iter.data();
+  int* cold_iter = d_cold_iter.data();
+  int* warm_iter = d_warm_iter.data();
+
+  double t0 = spray_checks::wall_time();
+  amrex::ParallelFor(num_pts, [=] AMREX_GPU_DEVICE(int n) noexcept {
+    Real ratio, B_M, Nu_0;
+    sample(n, ratio, B_M, Nu_0);
+    old_ptr[n] =
+      fixed_point_heat_coeff(ratio, B_M, B_eps, C_eps, Nu_0, old_iter[n]);
+  });
+  Gpu::streamSynchronize();
+  double t1 = spray_checks::wall_time();
+  amrex::ParallelFor(num_pts, [=] AMREX_GPU_DEVICE(int n) noexcept {
+    Real ratio, B_M, Nu_0;
+    sample(n, ratio, B_M, Nu_0);
+    Real B_T_prev = -1.;
+    new_ptr[n] =
+      calcHeatCoeff(ratio, B_M, B_eps, C_eps, Nu_0, B_T_prev, &cold_iter[n]);
+  });
+  Gpu::streamSynchronize();
+  double t2 = spray_checks::wall_time();
+  // Warm start from the solution at the B_M of the previous substep
+  amrex::ParallelFor(num_pts, [=] AMREX_GPU_DEVICE(int n) noexcept {
+    Real ratio, B_M, Nu_0;
+    sample(n, ratio, B_M, Nu_0);
+    Real B_T_prev = -1.;
+    calcHeatCoeff(
+      ratio, B_M * (1. - warm_pert), B_eps, C_eps, Nu_0, B_T_prev, nullptr);
+    calcHeatCoeff(ratio, B_M, B_eps, C_eps, Nu_0, B_T_prev, &warm_iter[n]);
+  });
+  amrex::ParallelFor(num_pts, [=] AMREX_GPU_DEVICE(int n) noexcept {
+    Real ratio, B_M, Nu_0;
+    sample(n, ratio, B_M, Nu_0);
+    ref_ptr[n] = bisect_heat_coeff(ratio, B_M, C_eps, Nu_0);
+  });
+  Gpu::streamSynchronize();
+
+  Vector<Real> h_old(num_pts);
+  Vector<Real> h_new(num_pts);
+  Vector<Real> h_ref(num_pts);
+  Vector<int> h_old_iter(num_pts);
+  Vector<int> h_cold_iter(num_pts);
+  Vector<int> h_warm_iter(num_pts);
+  Gpu::copy(Gpu::deviceToHost, d_old.begin(), d_old.end(), h_old.begin());
+  Gpu::copy(Gpu::deviceToHost, d_new.begin(), d_new.end(), h_new.begin());
+  Gpu::copy(Gpu::deviceToHost, d_ref.begin(), d_ref.end(), h_ref.begin());
+  Gpu::copy(
+    Gpu::deviceToHost, d_old_iter.begin(), d_old_iter.end(),
+    h_old_iter.begin());
+  Gpu::copy(
+    Gpu::deviceToHost, d_cold_iter.begin(), d_cold_iter.end(),
+    h_cold_iter.begin());
+  Gpu::copy(
+    Gpu::deviceToHost, d_warm_iter.begin(), d_warm_iter.end(),
+    h_warm_iter.begin());
+
+  // Compare with the bisection everywhere and with the fixed point iteration
+  // where it converged
+  auto rel_diff = [](const Real val, const Real ref) {
+    return std::abs(val - ref) / amrex::max(std::abs(ref), 1.E-300);
+  };
+  Real max_diff = 0.;
+  Real max_ref_diff = 0.;
+  Real max_old_ref_diff = 0.;
+  Long num_old_failed = 0;
+  bool all_finite = true;
+  for (int n = 0; n < num_pts; ++n) {
+    all_finite = all_finite && std::isfinite(h_new[n]);
+    max_ref_diff = amrex::max(max_ref_diff, rel_diff(h_new[n], h_ref[n]));
+    if (h_old_iter[n] >= max_iter) {
+      num_old_failed++;
+      max_old_ref_diff =
+        amrex::max(max_old_ref_diff, rel_diff(h_old[n], h_ref[n]));
+      continue;
+    }
+    max_diff = amrex::max(max_diff, rel_diff(h_new[n], h_old[n]));
+  }
+  const double ns = 1.E9 / static_cast<double>(num_pts);
+  amrex::Print() << "  " << num_pts << " samples, ratio " << ratio_range[0]
+                 << " to " << ratio_range[1] << ", B_M " << bm_range[0]
+                 << " to " << bm_range[1] << "; fixed point "
+                 << (t1 - t0) * ns << " ns/call, bracketed secant "
+                 << (t2 - t1) * ns << " ns/call\n";
+  amrex::Print() << "  Fixed point iteration did not converge for "
+                 << num_old_failed
+                 << " samples, maximum relative error there "
+                 << max_old_ref_diff << "\n";
+  const Vector<Long> hist_old = iter_hist(h_old_iter);
+  const Vector<Long> hist_cold = iter_hist(h_cold_iter);
+  const Vector<Long> hist_warm = iter_hist(h_warm_iter);
+  amrex::Print() << "  Iterations: fixed point, secant, warm started secant\n";
+  for (int b = 0; b < static_cast<int>(hist_old.size()); ++b) {
+    amrex::Print() << "    " << hist_label(b) << ": " << hist_old[b] << ", "
+                   << hist_cold[b] << ", " << hist_warm[b] << '\n';
+  }
+  int num_fail = 0;
+  num_fail += spray_checks::report(
+    "matches the fixed point iteration where it converged, maximum relative "
+    "difference " +
+      std::to_string(max_diff),
+    max_diff <= tol);
+  num_fail += spray_checks::report(
+    "matches the bisection for every sample, maximum relative difference " +
+      std::to_string(max_ref_diff),
+    max_ref_diff <= tol);
+  num_fail += spray_checks::report(
+    "converged with finite values for every sample",
+    all_finite && hist_cold.back() == 0 && hist_warm.back() == 0);
+  return num_fail;
+}
@@ -0,0 +1,162 @@
+#include <AMReX_ParmParse.H>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+// Jet that overrides get_new_particle(), so it is injected on the host
+class HostJet : public SprayJet
+{
+public:
+  using SprayJet::SprayJet;
+
+  bool get_new_particle(
+    const Real time,
+    const Real& phi_radial,
+    const Real& cur_radius,
+    Real& umag,
+    Real& theta_spread,
+    Real& phi_swirl,
+    Real& dia_part,
+    Real& T_part,
+    Real* Y_part) override
+  {
+    return SprayJet::get_new_particle(
+      time, phi_radial, cur_radius, umag, theta_spread, phi_swirl, dia_part,
+      T_part, Y_part);
+  }
+};
+
+// Number of parcels whose cell is not in the box of their tile, only counting
+// parcels inside of the domain since those outside are held in the tile
+// nearest the jet center
+Long
+num_misplaced(SprayParticleContainer& spc, const Geometry& geom)
+{
+  const auto plo = geom.ProbLoArray();
+  const auto dxi = geom.InvCellSizeArray();
+  const Box domain = geom.Domain();
+  Long num_bad = 0;
+  for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+    const Box tile_box = pti.tilebox();
+    const auto* pstruct = pti.GetArrayOfStructs().data();
+    num_bad += Reduce::Sum<Long>(
+      pti.numParticles(), [=] AMREX_GPU_DEVICE(int i) noexcept -> Long {
+        IntVect iv;
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          iv[dir] = static_cast<int>(amrex::Math::floor(
+                      (pstruct[i].pos(dir) - plo[dir]) * dxi[dir])) +
+                    domain.smallEnd(dir);
+        }
+        return (domain.contains(iv) && !tile_box.contains(iv)) ? 1 : 0;
+      });
+  }
+  return num_bad;
+}
+} // namespace
+
+int
+checkInjection()
+{
+  ParmParse pp("inject");
+  // Numbers of jets to time
+  Vector<int> num_jets_list = {1, 1000};
+  pp.queryarr("num_jets", num_jets_list);
+  // Parcels injected by each jet in each step
+  int parcels_per_step = 1000;
+  pp.query("parcels_per_step", parcels_per_step);
+  int num_steps = 5;
+  pp.query("num_steps", num_steps);
+  Real dia = 20.E-4;
+  pp.query("dia", dia);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const Geometry& geom = amr.Geom(0);
+  const SprayData* fdat = SprayParticleContainer::getSprayData();
+  const Real T_jet = 300.;
+  const GpuArray<Real, SPRAY_FUEL_NUM> Y_jet = {{1.}};
+  Real rho_part = 0.;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    rho_part += Y_jet[spf] / fdat->rhoL(T_jet, spf);
+  }
+  rho_part = 1. / rho_part;
+  const Real dt = 1.E-6;
+  const Real jet_vel = 1.E3;
+  const Real mdot = static_cast<Real>(parcels_per_step) * M_PI / 6. *
+                    rho_part * std::pow(dia, 3) / dt;
+  ParmParse pps("spray");
+  pps.add("diameter", dia);
+
+  int num_fail = 0;
+  for (const bool device_gen : {true, false}) {
+    const std::string path = device_gen ? "device" : "host";
+    for (const int num_jets : num_jets_list) {
+      // Jet centers on a lattice inside the domain, with the first jet on the
+      // upper x face of the domain
+      Vector<std::unique_ptr<SprayJet>> jets;
+      const int nside = static_cast<int>(
+        std::ceil(std::pow(static_cast<Real>(num_jets), 1. / AMREX_SPACEDIM)));
+      for (int n = 0; n < num_jets; ++n) {
+        RealVect cent;
+        int rem = n;
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          const int idx = rem % nside;
+          rem /= nside;
+          cent[dir] = geom.ProbLo(dir) + geom.ProbLength(dir) *
+                                           (static_cast<Real>(idx) + 0.5) /
+                                           static_cast<Real>(nside);
+        }
+        RealVect norm(AMREX_D_DECL(1., 0., 0.));
+        if (n == 0) {
+          cent[0] = geom.ProbHi(0);
+          norm[0] = -1.;
+        }
+        const std::string name = "jet" + std::to_string(n);
+        if (device_gen) {
+          jets.push_back(std::make_unique<SprayJet>(
+            name, geom, cent, norm, 20., 1.E-2, jet_vel, mdot, T_jet, Y_jet,
+            "Uniform"));
+        } else {
+          jets.push_back(std::make_unique<HostJet>(
+            name, geom, cent, norm, 20., 1.E-2, jet_vel, mdot, T_jet, Y_jet,
+            "Uniform"));
+        }
+        jets.back()->set_num_ppp(1.);
+      }
+      spc->clearParticles();
+      Real time = 0.;
+      double t0 = spray_checks::wall_time();
+      for (int step = 0; step < num_steps; ++step) {
+        for (auto& jet : jets) {
+          spc->sprayInjection(time, jet.get(), dt, 0);
+        }
+        time += dt;
+      }
+      Gpu::streamSynchronize();
+      double t1 = spray_checks::wall_time();
+      const Long num_inj = spc->TotalNumberOfParticles(true, false);
+      const Long expected = static_cast<Long>(num_jets) *
+                            static_cast<Long>(num_steps) *
+                            static_cast<Long>(parcels_per_step);
+      amrex::Print() << "  " << path << " generation, " << num_jets
+                     << " jets: " << num_inj << " parcels in " << t1 - t0
+                     << " s, " << static_cast<double>(num_inj) / (t1 - t0)
+                     << " parcels/s\n";
+      num_fail += spray_checks::report(
+        path + ", " + std::to_string(num_jets) +
+          " jets, injected parcel count within 1% of the mass flow rate",
+        std::abs(static_cast<Real>(num_inj - expected)) <=
+          0.01 * static_cast<Real>(expected));
+      if (device_gen) {
+        num_fail += spray_checks::report(
+          path + ", " + std::to_string(num_jets) +
+            " jets, parcels are in the tile containing them",
+          num_misplaced(*spc, geom) == 0);
+      }
+    }
+  }
+  spc->clearParticles();
+  return num_fail;
+}
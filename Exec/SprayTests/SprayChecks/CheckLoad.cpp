@@ -0,0 +1,156 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_FileSystem.H>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+const int num_vals = AMREX_SPACEDIM + SprayComps::pstateNum;
+
+// Sum of the position and each real component over all parcels
+Vector<Real>
+parcel_sums(SprayParticleContainer& spc)
+{
+  Vector<Real> sums(num_vals, 0.);
+  for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+    const auto* pstruct = pti.GetArrayOfStructs().data();
+    const int np = pti.numParticles();
+    for (int n = 0; n < num_vals; ++n) {
+      sums[n] +=
+        Reduce::Sum<Real>(np, [=] AMREX_GPU_DEVICE(int i) noexcept -> Real {
+          const auto& p = pstruct[i];
+          return (n < AMREX_SPACEDIM) ? p.pos(n)
+                                      : parcelState(p, n - AMREX_SPACEDIM);
+        });
+    }
+  }
+  ParallelDescriptor::ReduceRealSum(sums.data(), num_vals);
+  return sums;
+}
+
+// Write the same random parcels to an ascii file, as read by
+// InitFromSprayAsciiFile, and a binary file in double precision, and return the
+// sums of their values
+Vector<Real>
+write_files(
+  const Geometry& geom,
+  const Long num_parcels,
+  const std::string& ascii_file,
+  const std::string& binary_file)
+{
+  Vector<Real> sums(num_vals, 0.);
+  std::mt19937_64 gen(42);
+  std::uniform_real_distribution<double> dist(0., 1.);
+  std::ofstream afs(ascii_file);
+  std::ofstream bfs(binary_file, std::ios::out | std::ios::binary);
+  afs << std::setprecision(17) << num_parcels << '\n';
+  const char tag[] = "PMSPRAY1";
+  const std::int64_t num = num_parcels;
+  const std::int32_t vals[4] = {AMREX_SPACEDIM, SprayComps::pstateNum, 8, 0};
+  bfs.write(tag, 8);
+  bfs.write(reinterpret_cast<const char*>(&num), 8);
+  bfs.write(reinterpret_cast<const char*>(vals), 4 * 4);
+  Vector<double> rec(num_vals);
+  for (Long i = 0; i < num_parcels; ++i) {
+    for (int n = 0; n < num_vals; ++n) {
+      rec[n] = dist(gen);
+      if (n < AMREX_SPACEDIM) {
+        rec[n] = geom.ProbLo(n) + rec[n] * geom.ProbLength(n);
+      }
+      sums[n] += rec[n];
+      afs << rec[n] << ((n + 1 < num_vals) ? ' ' : '\n');
+    }
+    bfs.write(
+      reinterpret_cast<const char*>(rec.data()),
+      static_cast<std::streamsize>(num_vals * sizeof(double)));
+  }
+  return sums;
+}
+} // namespace
+
+int
+checkLoad()
+{
+  ParmParse pp("load");
+  Long num_parcels = 200000;
+  pp.query("num_parcels", num_parcels);
+  std::string ascii_file = "spray_check_load.txt";
+  pp.query("ascii_file", ascii_file);
+  std::string binary_file = "spray_check_load.bin";
+  pp.query("binary_file", binary_file);
+  // Relative tolerance of the sums of the loaded values, which are rounded
+  // when the parcel state is stored in single precision
+  Real tol = (sizeof(SprayReal) == sizeof(float)) ? 1.E-6 : 1.E-12;
+  pp.query("tol", tol);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> ascii_pc = amr.makeSprayContainer();
+  std::unique_ptr<SprayParticleContainer> binary_pc =
+    amr.makeSprayContainer();
+  const Geometry& geom = amr.Geom(0);
+  Vector<Real> exact_sums(num_vals, 0.);
+  if (ParallelDescriptor::IOProcessor()) {
+    exact_sums = write_files(geom, num_parcels, ascii_file, binary_file);
+  }
+  ParallelDescriptor::Bcast(
+    exact_sums.data(), num_vals, ParallelDescriptor::IOProcessorNumber());
+  ParallelDescriptor::Barrier();
+
+  ascii_pc->clearParticles();
+  binary_pc->clearParticles();
+  double t0 = spray_checks::wall_time();
+  ascii_pc->InitFromSprayAsciiFile(ascii_file);
+  Gpu::streamSynchronize();
+  ParallelDescriptor::Barrier();
+  double t1 = spray_checks::wall_time();
+  const bool is_binary = binary_pc->InitFromBinaryFile(binary_file);
+  Gpu::streamSynchronize();
+  ParallelDescriptor::Barrier();
+  double t2 = spray_checks::wall_time();
+
+  const Long num_ascii = ascii_pc->TotalNumberOfParticles(true, false);
+  const Long num_binary = binary_pc->TotalNumberOfParticles(true, false);
+  const Vector<Real> ascii_sums = parcel_sums(*ascii_pc);
+  const Vector<Real> binary_sums = parcel_sums(*binary_pc);
+  Real max_diff = 0.;
+  Real max_ascii_diff = 0.;
+  for (int n = 0; n < num_vals; ++n) {
+    const Real ref = amrex::max(std::abs(exact_sums[n]), 1.E-300);
+    max_diff =
+      amrex::max(max_diff, std::abs(binary_sums[n] - exact_sums[n]) / ref);
+    max_ascii_diff =
+      amrex::max(max_ascii_diff, std::abs(ascii_sums[n] - exact_sums[n]) / ref);
+  }
+  const double bytes_parcel = static_cast<double>(num_vals * sizeof(double));
+  amrex::Print() << "  " << num_parcels << " parcels on "
+                 << ParallelDescriptor::NProcs() << " ranks: ascii "
+                 << t1 - t0 << " s, binary " << t2 - t1 << " s, speedup "
+                 << (t1 - t0) / amrex::max(t2 - t1, 1.E-12) << ", binary file "
+                 << 1.E-6 * bytes_parcel * static_cast<double>(num_parcels)
+                 << " MB\n";
+  int num_fail = 0;
+  num_fail += spray_checks::report(
+    "binary file recognized and all parcels read",
+    is_binary && num_binary == num_parcels && num_ascii == num_parcels);
+  num_fail += spray_checks::report(
+    "binary values match the written values, maximum relative difference " +
+      std::to_string(max_diff),
+    max_diff <= tol);
+  num_fail += spray_checks::report(
+    "ascii values match the written values, maximum relative difference " +
+      std::to_string(max_ascii_diff),
+    max_ascii_diff <= tol);
+  ascii_pc->clearParticles();
+  binary_pc->clearParticles();
+  ParallelDescriptor::Barrier();
+  if (ParallelDescriptor::IOProcessor()) {
+    FileSystem::Remove(ascii_file);
+    FileSystem::Remove(binary_file);
+  }
+  return num_fail;
+}
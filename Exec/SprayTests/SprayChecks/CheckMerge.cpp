@@ -0,0 +1,181 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_Random.H>
+#include <AMReX_GpuContainers.H>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+#include "SprayMerge.H"
+
+using namespace amrex;
+
+namespace {
+// Totals over the valid parcels of a level
+struct SprayTotals
+{
+  Long num_parcels = 0;
+  Real num_drops = 0.;
+  Real mass = 0.;
+  RealVect mom = RealVect::TheZeroVector();
+  Real enthalpy = 0.;
+  Real d32 = 0.;
+};
+
+SprayTotals
+spray_totals(SprayParticleContainer& spc, const SprayData* d_fdat)
+{
+  using PType = SprayParticleContainer::ParticleType;
+  ReduceOps<
+    ReduceOpSum, ReduceOpSum, ReduceOpSum, AMREX_D_DECL(
+                                             ReduceOpSum, ReduceOpSum,
+                                             ReduceOpSum),
+    ReduceOpSum, ReduceOpSum, ReduceOpSum>
+    reduce_op;
+  ReduceData<
+    Long, Real, Real, AMREX_D_DECL(Real, Real, Real), Real, Real, Real>
+    reduce_data(reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+  for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+    const PType* pstruct = pti.GetArrayOfStructs().data();
+    reduce_op.eval(
+      pti.numParticles(), reduce_data,
+      [=] AMREX_GPU_DEVICE(const int i) -> ReduceTuple {
+        const PType& p = pstruct[i];
+        if (p.id() <= 0) {
+          return {0, 0., 0., AMREX_D_DECL(0., 0., 0.), 0., 0., 0.};
+        }
+        const Real num = parcelState(p, SprayComps::pstateNumDens);
+        const Real mass = num * parcelDropMass(p, *d_fdat);
+        Real Y_part[SPRAY_FUEL_NUM];
+        getLiquidY(p, *d_fdat, Y_part);
+        Real cp = 0.;
+        for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+          cp += Y_part[spf] * d_fdat->cp[spf];
+        }
+        const Real dia = parcelState(p, SprayComps::pstateDia);
+        return {
+          1,
+          num,
+          mass,
+          AMREX_D_DECL(
+            mass * parcelState(p, SprayComps::pstateVel),
+            mass * parcelState(p, SprayComps::pstateVel + 1),
+            mass * parcelState(p, SprayComps::pstateVel + 2)),
+          mass * cp * parcelState(p, SprayComps::pstateT),
+          num * dia * dia * dia,
+          num * dia * dia};
+      });
+  }
+  ReduceTuple hv = reduce_data.value();
+  SprayTotals tot;
+  tot.num_parcels = amrex::get<0>(hv);
+  tot.num_drops = amrex::get<1>(hv);
+  tot.mass = amrex::get<2>(hv);
+  AMREX_D_TERM(tot.mom[0] = amrex::get<3>(hv);
+               , tot.mom[1] = amrex::get<4>(hv);
+               , tot.mom[2] = amrex::get<5>(hv);)
+  tot.enthalpy = amrex::get<3 + AMREX_SPACEDIM>(hv);
+  const Real d3 = amrex::get<4 + AMREX_SPACEDIM>(hv);
+  const Real d2 = amrex::get<5 + AMREX_SPACEDIM>(hv);
+  tot.d32 = (d2 > 0.) ? d3 / d2 : 0.;
+  return tot;
+}
+
+Real
+rel_diff(const Real& val, const Real& ref)
+{
+  return std::abs(val - ref) / amrex::max(std::abs(ref), 1.E-300);
+}
+} // namespace
+
+int
+checkMerge()
+{
+  ParmParse pp("merge");
+  // Lattice of parcels in each direction, several parcels per cell are needed
+  // for merges to happen
+  int num_part = 128;
+  pp.query("num_part", num_part);
+  Real dia = 20.E-4;
+  pp.query("dia", dia);
+  // Relative perturbation of the diameter, velocity, and number of droplets,
+  // and the perturbation of the temperature
+  Real rel_pert = 0.1;
+  pp.query("rel_pert", rel_pert);
+  Real temp_pert = 5.;
+  pp.query("temp_pert", temp_pert);
+  Real tol = 1.E-10;
+  pp.query("tol", tol);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const SprayData* fdat = SprayParticleContainer::getSprayData();
+  Gpu::AsyncArray<SprayData> fdat_arr(fdat, 1);
+  const SprayData* d_fdat = fdat_arr.data();
+  const Real T_part = 300.;
+  const RealVect vel_part(AMREX_D_DECL(1.E3, 0., 0.));
+  const Real Y_part[SPRAY_FUEL_NUM] = {1.};
+  spc->uniformSprayInit(
+    IntVect(AMREX_D_DECL(num_part, num_part, num_part)), vel_part, dia,
+    T_part, Y_part, 0, 1, 10.);
+
+  // Perturb the parcels so only some of them can be merged
+  for (MyParIter pti(*spc, 0); pti.isValid(); ++pti) {
+    auto* pstruct = pti.GetArrayOfStructs().data();
+    amrex::ParallelForRNG(
+      pti.numParticles(), [=] AMREX_GPU_DEVICE(
+                            int i, amrex::RandomEngine const& engine) noexcept {
+        auto& p = pstruct[i];
+        auto pert = [&]() { return 2. * amrex::Random(engine) - 1.; };
+        parcelState(p, SprayComps::pstateDia) *= 1. + rel_pert * pert();
+        parcelState(p, SprayComps::pstateNumDens) *= 1. + rel_pert * pert();
+        parcelState(p, SprayComps::pstateT) += temp_pert * pert();
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          parcelState(p, SprayComps::pstateVel + dir) +=
+            rel_pert * vel_part[0] * pert();
+        }
+      });
+  }
+  Gpu::streamSynchronize();
+
+  const SprayTotals before = spray_totals(*spc, d_fdat);
+  double t0 = spray_checks::wall_time();
+  const Long num_removed = spc->mergeParcels(0);
+  Gpu::streamSynchronize();
+  double t1 = spray_checks::wall_time();
+  const SprayTotals after = spray_totals(*spc, d_fdat);
+
+  amrex::Print() << "  " << before.num_parcels << " parcels, " << num_removed
+                 << " removed ("
+                 << 100. * static_cast<Real>(num_removed) /
+                      static_cast<Real>(before.num_parcels)
+                 << "%) in " << t1 - t0 << " s\n";
+  amrex::Print() << "  d32 " << before.d32 << " before, " << after.d32
+                 << " after merging, relative change "
+                 << rel_diff(after.d32, before.d32) << '\n';
+  int num_fail = 0;
+  num_fail += spray_checks::report(
+    "parcels were merged",
+    num_removed > 0 && num_removed < before.num_parcels &&
+      after.num_parcels == before.num_parcels - num_removed);
+  num_fail += spray_checks::report(
+    "number of droplets conserved",
+    rel_diff(after.num_drops, before.num_drops) <= tol);
+  num_fail += spray_checks::report(
+    "liquid mass conserved", rel_diff(after.mass, before.mass) <= tol);
+  Real mom_err = 0.;
+  for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+    mom_err = amrex::max(
+      mom_err, std::abs(after.mom[dir] - before.mom[dir]) /
+                 (before.mass * vel_part[0]));
+  }
+  num_fail += spray_checks::report("momentum conserved", mom_err <= tol);
+  num_fail += spray_checks::report(
+    "liquid enthalpy conserved",
+    rel_diff(after.enthalpy, before.enthalpy) <= tol);
+  // The diameter perturbations are within the merge tolerance, so the Sauter
+  // mean diameter changes only by a fraction of it
+  num_fail += spray_checks::report(
+    "Sauter mean diameter within the merge diameter tolerance",
+    rel_diff(after.d32, before.d32) <= rel_pert);
+  spc->clearParticles();
+  return num_fail;
+}
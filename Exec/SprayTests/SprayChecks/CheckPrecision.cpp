@@ -0,0 +1,156 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_GpuContainers.H>
+#include "PelePhysics.H"
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+#include "SprayMerge.H"
+
+using namespace amrex;
+
+namespace {
+// Liquid mass and mean diameter over the valid parcels of a level
+std::pair<Real, Real>
+liquid_totals(SprayParticleContainer& spc, const SprayData* d_fdat)
+{
+  using PType = SprayParticleContainer::ParticleType;
+  ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+  ReduceData<Real, Real, Real> reduce_data(reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+  for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+    const PType* pstruct = pti.GetArrayOfStructs().data();
+    reduce_op.eval(
+      pti.numParticles(), reduce_data,
+      [=] AMREX_GPU_DEVICE(const int i) -> ReduceTuple {
+        const PType& p = pstruct[i];
+        if (p.id() <= 0) {
+          return {0., 0., 0.};
+        }
+        const Real num = parcelState(p, SprayComps::pstateNumDens);
+        return {
+          num * parcelDropMass(p, *d_fdat),
+          num * parcelState(p, SprayComps::pstateDia), num};
+      });
+  }
+  ReduceTuple hv = reduce_data.value();
+  Real tots[3] = {amrex::get<0>(hv), amrex::get<1>(hv), amrex::get<2>(hv)};
+  ParallelDescriptor::ReduceRealSum(tots, 3);
+  return {tots[0], (tots[2] > 0.) ? tots[1] / tots[2] : 0.};
+}
+} // namespace
+
+int
+checkPrecision()
+{
+  ParmParse pp("prec");
+  // Lattice of droplets at rest in hot air, at most one parcel per cell so no
+  // parcels collide
+  int num_part = 32;
+  pp.query("num_part", num_part);
+  Real dia = 50.E-4;
+  pp.query("dia", dia);
+  Real T_gas = 1000.;
+  pp.query("T_gas", T_gas);
+  Real dt = 1.E-4;
+  pp.query("dt", dt);
+  int num_steps = 20;
+  pp.query("num_steps", num_steps);
+  // Tolerance of the mass balance relative to the evaporated mass
+  Real tol = 1.E-10;
+  pp.query("tol", tol);
+
+  // Storage of each parcel, and what it would be with the state stored in
+  // ParticleReal
+  using PType = SprayParticleContainer::ParticleType;
+  const auto part_bytes = static_cast<int>(sizeof(PType));
+  const int full_bytes =
+    part_bytes + static_cast<int>(sizeof(ParticleReal)) *
+                   (SprayComps::pstateNum - static_cast<int>(NSR_SPR));
+  const std::string prec =
+    (sizeof(SprayReal) == sizeof(float)) ? "single" : "double";
+  amrex::Print() << "  " << SprayComps::pstateNum << " state components in "
+                 << prec << " precision, " << part_bytes
+                 << " bytes per parcel, " << full_bytes
+                 << " with the state in ParticleReal\n";
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const Geometry& geom = amr.Geom(0);
+  if (num_part > geom.Domain().length(0)) {
+    amrex::Abort("prec.num_part must not exceed the number of cells");
+  }
+  const SprayData* fdat = SprayParticleContainer::getSprayData();
+  Gpu::AsyncArray<SprayData> fdat_arr(fdat, 1);
+  const SprayData* d_fdat = fdat_arr.data();
+  const SprayComps scomps = SprayCheckAmr::checkComps();
+  SprayParticleContainer::AssignSprayComps(scomps);
+
+  const int num_ghost = 2;
+  const BoxArray& ba = amr.boxArray(0);
+  const DistributionMapping& dm = amr.DistributionMap(0);
+  MultiFab state(ba, dm, AMREX_SPACEDIM + 3 + NUM_SPECIES, num_ghost);
+  MultiFab source(ba, dm, AMREX_SPACEDIM + 2 + NUM_SPECIES, num_ghost);
+  SprayCheckAmr::fillAirState(state, T_gas, 0.);
+  const Real cell_vol = AMREX_D_TERM(
+    geom.CellSize(0), *geom.CellSize(1), *geom.CellSize(2));
+  const Real spray_cfl_lev = 0.5;
+  pele::physics::transport::TransportParams<pele::physics::TransportType>
+    trans_parms;
+  trans_parms.allocate();
+
+  const IntVect lattice(AMREX_D_DECL(num_part, num_part, num_part));
+  const RealVect vel_part = RealVect::TheZeroVector();
+  const Real T_part = 300.;
+  const Real Y_part[SPRAY_FUEL_NUM] = {1.};
+  spc->clearParticles();
+  spc->uniformSprayInit(lattice, vel_part, dia, T_part, Y_part, 0);
+  const Long np = spc->TotalNumberOfParticles(true, false);
+  const std::pair<Real, Real> start = liquid_totals(*spc, d_fdat);
+
+  // The gas gains the mass deposited in the source in each step, which must
+  // match the mass the liquid loses
+  Real gas_mass = 0.;
+  Real gas_fuel = 0.;
+  double run_time = 0.;
+  for (int step = 0; step < num_steps; ++step) {
+    source.setVal(0.);
+    double t0 = spray_checks::wall_time();
+    spc->moveKickDrift(
+      state, source, 0, dt, step * dt, false, false, num_ghost, num_ghost,
+      true, trans_parms.device_trans_parm(), spray_cfl_lev);
+    Gpu::streamSynchronize();
+    run_time += spray_checks::wall_time() - t0;
+    gas_mass += dt * cell_vol * source.sum(scomps.rhoSrcIndx);
+    for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+      gas_fuel += dt * cell_vol * source.sum(scomps.specSrcIndx + spf);
+    }
+  }
+  const std::pair<Real, Real> end = liquid_totals(*spc, d_fdat);
+  const Real evap_mass = start.first - end.first;
+  const Real mass_err =
+    std::abs(evap_mass - gas_mass) / amrex::max(evap_mass, 1.E-300);
+  const Real fuel_err =
+    std::abs(gas_fuel - gas_mass) / amrex::max(evap_mass, 1.E-300);
+  amrex::Print() << "  " << np << " parcels, " << num_steps << " steps, "
+                 << 1.E9 * run_time / static_cast<double>(np * num_steps)
+                 << " ns per parcel update\n";
+  amrex::Print() << "  evaporated " << 100. * evap_mass / start.first
+                 << "% of the liquid, mean diameter " << end.second
+                 << " cm, relative mass balance error " << mass_err << '\n';
+  trans_parms.deallocate();
+  spc->clearParticles();
+
+  int num_fail = 0;
+  num_fail += spray_checks::report(
+    "parcel storage matches the state precision",
+    NSR_SPR * static_cast<int>(sizeof(ParticleReal)) >=
+        SprayComps::pstateNum * static_cast<int>(sizeof(SprayReal)) &&
+      (NSR_SPR - 1) * static_cast<int>(sizeof(ParticleReal)) <
+        SprayComps::pstateNum * static_cast<int>(sizeof(SprayReal)));
+  num_fail += spray_checks::report(
+    "droplets evaporated", evap_mass > 0.);
+  num_fail += spray_checks::report(
+    "gas mass source matches the liquid mass lost", mass_err <= tol);
+  num_fail += spray_checks::report(
+    "fuel species sources sum to the mass source", fuel_err <= tol);
+  return num_fail;
+}
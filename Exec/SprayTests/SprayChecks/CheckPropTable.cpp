@@ -0,0 +1,244 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_GpuContainers.H>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+// Property prop of the first fuel at T, from the table if fdat has one
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE Real
+prop_val(const SprayData& fdat, const int prop, const Real T)
+{
+  switch (prop) {
+  case LiquidPropTable::rho:
+    return fdat.rhoL(T, 0);
+  case LiquidPropTable::mu:
+    return fdat.muL(T, 0);
+  case LiquidPropTable::lambda:
+    return fdat.lambdaL(T, 0);
+  default:
+    return fdat.psat(T, 0);
+  }
+}
+
+// Temperature i of n evenly spaced over T_lo to T_hi, offset by half a
+// spacing so they mostly fall between the table temperatures
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE Real
+eval_temp(const int i, const int n, const Real T_lo, const Real T_hi)
+{
+  return T_lo + (T_hi - T_lo) * (static_cast<Real>(i) + 0.5) /
+                  static_cast<Real>(n);
+}
+
+// Table of prop sampled from the fit in fdat at num_pts temperatures from T_lo
+// to T_hi, as written by propcoeff.py and read by readPropTable
+LiquidPropTable
+make_table(
+  const SprayData& fdat,
+  const int prop,
+  const int num_pts,
+  const Real T_lo,
+  const Real T_hi)
+{
+  LiquidPropTable tab;
+  tab.num_pts = num_pts;
+  tab.T_min = T_lo;
+  tab.T_max = T_hi;
+  tab.dTi = static_cast<Real>(num_pts - 1) / (T_hi - T_lo);
+  tab.log_vals =
+    (prop == LiquidPropTable::mu || prop == LiquidPropTable::psat);
+  for (int k = 0; k < num_pts; ++k) {
+    const Real T = T_lo + (T_hi - T_lo) * static_cast<Real>(k) /
+                            static_cast<Real>(num_pts - 1);
+    const Real val = prop_val(fdat, prop, T);
+    tab.val[k] = tab.log_vals ? std::log(val) : val;
+  }
+  tab.setSlopes();
+  return tab;
+}
+
+// Sum of the four properties at num_evals temperatures, and the time per
+// temperature in ns
+double
+time_props(
+  const SprayData* d_fdat,
+  const int num_evals,
+  const Real T_lo,
+  const Real T_hi,
+  Real* sum_ptr)
+{
+  double t0 = spray_checks::wall_time();
+  amrex::ParallelFor(num_evals, [=] AMREX_GPU_DEVICE(int i) noexcept {
+    const Real T = eval_temp(i, num_evals, T_lo, T_hi);
+    Real sum = 0.;
+    for (int prop = 0; prop < LiquidPropTable::num_props; ++prop) {
+      sum += prop_val(*d_fdat, prop, T);
+    }
+    sum_ptr[i] = sum;
+  });
+  Gpu::streamSynchronize();
+  return 1.E9 * (spray_checks::wall_time() - t0) /
+         static_cast<double>(num_evals);
+}
+} // namespace
+
+int
+checkPropTable()
+{
+  ParmParse pp("prop");
+  // Table sizes, in increasing order, and the tabulated temperatures
+  Vector<int> num_pts = {8, 16, 32, 64};
+  pp.queryarr("num_pts", num_pts);
+  Vector<Real> T_range = {280., 520.};
+  pp.queryarr("T_range", T_range);
+  // Temperatures compared between the tables and the fits and timed
+  int num_evals = 1000000;
+  pp.query("num_evals", num_evals);
+  // Largest relative difference of the largest table to the fits
+  Real tol = 1.E-3;
+  pp.query("tol", tol);
+  for (const int npts : num_pts) {
+    if (npts < 2 || npts > LiquidPropTable::max_pts) {
+      amrex::Abort(
+        "prop.num_pts must be between 2 and " +
+        std::to_string(LiquidPropTable::max_pts));
+    }
+  }
+
+  // Fits of the first fuel, with the rho, mu, and lambda fits replaced if
+  // given since the fuel inputs only set a constant density and viscosity;
+  // the saturation pressure is the Antoine fit of the fuel
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  SprayData fit = *SprayParticleContainer::getSprayData();
+  fit.tab_range_count = nullptr;
+  const int num_tabs = SPRAY_FUEL_NUM * LiquidPropTable::num_props;
+  for (int t = 0; t < num_tabs; ++t) {
+    fit.prop_tab[t].num_pts = 0;
+  }
+  const std::string coef_names[3] = {"rho_coef", "mu_coef", "lambda_coef"};
+  Real* coefs[3] = {
+    fit.rho_coef.data(), fit.mu_coef.data(), fit.lambda_coef.data()};
+  for (int c = 0; c < 3; ++c) {
+    Vector<Real> coef;
+    if (pp.queryarr(coef_names[c].c_str(), coef)) {
+      if (coef.size() != 4) {
+        amrex::Abort("prop." + coef_names[c] + " must have 4 values");
+      }
+      for (int k = 0; k < 4; ++k) {
+        coefs[c][k] = coef[k];
+      }
+    }
+  }
+  const std::string prop_names[LiquidPropTable::num_props] = {
+    "rho", "mu", "lambda", "psat"};
+  const Real T_lo = T_range[0];
+  const Real T_hi = T_range[1];
+  for (int prop = 0; prop < LiquidPropTable::num_props; ++prop) {
+    for (int k = 0; k <= 10; ++k) {
+      if (prop_val(fit, prop, T_lo + 0.1 * k * (T_hi - T_lo)) <= 0.) {
+        amrex::Abort(
+          "The " + prop_names[prop] +
+          " fit must be positive over prop.T_range");
+      }
+    }
+  }
+  Gpu::AsyncArray<SprayData> fit_arr(&fit, 1);
+  const SprayData* d_fit = fit_arr.data();
+
+  // Each table against the fit it was sampled from, at temperatures between
+  // the grid points; the difference must shrink as the tables are refined,
+  // and the largest table must be within tol
+  int num_fail = 0;
+  SprayData tab_dat = fit;
+  GpuArray<Real, LiquidPropTable::num_props> prev_diff = {{0.}};
+  bool converged = true;
+  const int num_sizes = static_cast<int>(num_pts.size());
+  for (int n = 0; n < num_sizes; ++n) {
+    for (int prop = 0; prop < LiquidPropTable::num_props; ++prop) {
+      tab_dat.prop_tab[prop] = make_table(fit, prop, num_pts[n], T_lo, T_hi);
+    }
+    Gpu::AsyncArray<SprayData> tab_arr(&tab_dat, 1);
+    const SprayData* d_tab = tab_arr.data();
+    amrex::Print() << "  " << num_pts[n] << " temperatures, maximum relative "
+                   << "difference to the fit:";
+    for (int prop = 0; prop < LiquidPropTable::num_props; ++prop) {
+      const Real max_diff = Reduce::Max<Real>(
+        num_evals, [=] AMREX_GPU_DEVICE(int i) noexcept -> Real {
+          const Real T = eval_temp(i, num_evals, T_lo, T_hi);
+          const Real val = prop_val(*d_fit, prop, T);
+          return std::abs(prop_val(*d_tab, prop, T) - val) / val;
+        });
+      amrex::Print() << " " << prop_names[prop] << " " << max_diff;
+      if (n > 0) {
+        converged =
+          converged && max_diff <= amrex::max(prev_diff[prop], 1.E-12);
+      }
+      prev_diff[prop] = max_diff;
+    }
+    amrex::Print() << '\n';
+  }
+  Real max_diff = 0.;
+  for (int prop = 0; prop < LiquidPropTable::num_props; ++prop) {
+    max_diff = amrex::max(max_diff, prev_diff[prop]);
+  }
+  num_fail += spray_checks::report(
+    "table differences to the fits shrink as the tables are refined",
+    converged);
+  num_fail += spray_checks::report(
+    "largest tables match the fits, maximum relative difference " +
+      std::to_string(max_diff),
+    max_diff <= tol);
+
+  // The interpolation must not create extrema, so the tables of the
+  // monotone fits are monotone in the same direction
+  Gpu::AsyncArray<SprayData> tab_arr(&tab_dat, 1);
+  const SprayData* d_tab = tab_arr.data();
+  const int num_flips = Reduce::Sum<int>(
+    num_evals - 1, [=] AMREX_GPU_DEVICE(int i) noexcept -> int {
+      const Real T0 = eval_temp(i, num_evals, T_lo, T_hi);
+      const Real T1 = eval_temp(i + 1, num_evals, T_lo, T_hi);
+      int flips = 0;
+      for (int prop = 0; prop < LiquidPropTable::num_props; ++prop) {
+        const Real d_fit_val =
+          prop_val(*d_fit, prop, T1) - prop_val(*d_fit, prop, T0);
+        const Real d_tab_val =
+          prop_val(*d_tab, prop, T1) - prop_val(*d_tab, prop, T0);
+        flips += (d_fit_val * d_tab_val < 0.) ? 1 : 0;
+      }
+      return flips;
+    });
+  num_fail += spray_checks::report(
+    "tables are monotone where the fits are, " + std::to_string(num_flips) +
+      " reversed intervals",
+    num_flips == 0);
+
+  // Temperatures outside the table are clamped to its range and counted
+  Long range_count = 0;
+  bool clamped = true;
+  for (int t = 0; t < num_tabs; ++t) {
+    const LiquidPropTable& tab = tab_dat.prop_tab[t];
+    if (tab.num_pts == 0) {
+      continue;
+    }
+    clamped = clamped &&
+              tab.eval(T_lo - 10., &range_count) == tab.eval(T_lo, nullptr) &&
+              tab.eval(T_hi + 10., &range_count) == tab.eval(T_hi, nullptr) &&
+              tab.eval(0.5 * (T_lo + T_hi), &range_count) > 0.;
+  }
+  num_fail += spray_checks::report(
+    "temperatures outside the tables are clamped and counted",
+    clamped && range_count == 2 * LiquidPropTable::num_props);
+
+  // Cost of the four properties at a temperature with the fits and with the
+  // largest tables
+  Gpu::DeviceVector<Real> d_sum(num_evals);
+  const double fit_ns = time_props(d_fit, num_evals, T_lo, T_hi, d_sum.data());
+  const double tab_ns = time_props(d_tab, num_evals, T_lo, T_hi, d_sum.data());
+  amrex::Print() << "  rho, mu, lambda, and psat at " << num_evals
+                 << " temperatures: fits " << fit_ns << " ns, "
+                 << num_pts[num_sizes - 1] << " point tables " << tab_ns
+                 << " ns per temperature\n";
+  return num_fail;
+}
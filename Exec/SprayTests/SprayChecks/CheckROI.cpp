@@ -0,0 +1,170 @@
+#include <AMReX_ParmParse.H>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include "SprayChecks.H"
+#include "SprayJet.H"
+
+using namespace amrex;
+
+namespace {
+// Jet that exposes its rate of injection data
+class ROIJet : public SprayJet
+{
+public:
+  ROIJet(const Geometry& geom, const RealVect& cent)
+    : SprayJet(
+        "roi_jet",
+        geom,
+        cent,
+        RealVect(AMREX_D_DECL(1., 0., 0.)),
+        20.,
+        1.E-2,
+        1.E3,
+        1.,
+        300.,
+        {{1.}},
+        "Uniform")
+  {
+  }
+
+  const Vector<Real>& times() const { return inject_time; }
+  const Vector<Real>& mdots() const { return inject_mass; }
+  Real roi_dt() const { return m_roiDt; }
+};
+
+// Lookup used before direct indexing and binary search: a linear scan from the
+// start of the data for the first time that is not less than time
+Real
+linear_roi(const Vector<Real>& times, const Vector<Real>& vals, const Real time)
+{
+  const int nvals = static_cast<int>(times.size());
+  if (time <= times[0]) {
+    return vals[0];
+  } else if (time >= times[nvals - 1]) {
+    return vals[nvals - 1];
+  }
+  int i = 0;
+  Real ctime = times[0];
+  while (ctime < time) {
+    ctime = times[++i];
+  }
+  const Real invt = (time - times[i - 1]) / (times[i] - times[i - 1]);
+  return vals[i - 1] + (vals[i] - vals[i - 1]) * invt;
+}
+
+// Write a rate of injection file with num_vals samples, times in ms; the
+// first and last samples have zero mass flow rate
+void
+write_roi_file(const std::string& file, const int num_vals, const bool uniform)
+{
+  std::mt19937 gen(1234);
+  std::uniform_real_distribution<double> jitter(0., 0.4);
+  const double dt = 1.E-4;
+  std::ofstream out(file);
+  out << "time[ms];mdot\n" << std::setprecision(17);
+  for (int i = 0; i < num_vals; ++i) {
+    double time = static_cast<double>(i) * dt;
+    if (!uniform) {
+      time += jitter(gen) * dt;
+    }
+    double mdot = 0.;
+    if (i > 0 && i < num_vals - 1) {
+      mdot = 1. + 0.5 * std::sin(2. * M_PI * static_cast<double>(i) /
+                                 static_cast<double>(num_vals));
+    }
+    out << time << ";" << mdot << '\n';
+  }
+}
+} // namespace
+
+int
+checkROI()
+{
+  ParmParse pp("roi");
+  int num_vals = 100000;
+  pp.query("num_vals", num_vals);
+  int num_lookups = 100000;
+  pp.query("num_lookups", num_lookups);
+
+  Box domain(IntVect(AMREX_D_DECL(0, 0, 0)), IntVect(AMREX_D_DECL(7, 7, 7)));
+  RealBox real_box({AMREX_D_DECL(0., 0., 0.)}, {AMREX_D_DECL(1., 1., 1.)});
+  Array<int, AMREX_SPACEDIM> is_per = {AMREX_D_DECL(0, 0, 0)};
+  Geometry geom(domain, real_box, 0, is_per);
+  ROIJet jet(geom, RealVect(AMREX_D_DECL(0.5, 0.5, 0.5)));
+
+  int num_fail = 0;
+  for (const bool uniform : {true, false}) {
+    const std::string label = uniform ? "uniform" : "nonuniform";
+    const std::string file = "roi_" + label + ".txt";
+    write_roi_file(file, num_vals, uniform);
+    jet.readROI(file, 0.7, 0.8);
+    const Vector<Real>& times = jet.times();
+    const Vector<Real>& mdots = jet.mdots();
+    const int nt = static_cast<int>(times.size());
+    num_fail += spray_checks::report(
+      label + " spacing detected", (jet.roi_dt() > 0.) == uniform);
+
+    // Sample times, midpoints, points just off the samples, and times outside
+    // of the data
+    std::mt19937 gen(42);
+    const Real tlo = times[0];
+    const Real thi = times[nt - 1];
+    std::uniform_real_distribution<Real> rtime(
+      tlo - 0.01 * (thi - tlo), thi + 0.01 * (thi - tlo));
+    Vector<Real> test_times;
+    for (int i = 0; i < nt; ++i) {
+      test_times.push_back(times[i]);
+      test_times.push_back(std::nextafter(times[i], thi + 1.));
+      test_times.push_back(std::nextafter(times[i], tlo - 1.));
+      if (i > 0) {
+        test_times.push_back(0.5 * (times[i - 1] + times[i]));
+      }
+    }
+    for (int i = 0; i < num_lookups; ++i) {
+      test_times.push_back(rtime(gen));
+    }
+    Real max_err = 0.;
+    for (const Real time : test_times) {
+      const Real val = jet.interpolateROI(time, mdots.dataPtr());
+      const Real ref = linear_roi(times, mdots, time);
+      max_err = amrex::max(max_err, std::abs(val - ref));
+    }
+    num_fail += spray_checks::report(
+      label + " lookup matches linear search", max_err <= 1.E-12);
+
+    // Time random lookups, as for jets sharing the data, and increasing ones,
+    // as for a single jet advancing in time
+    Vector<Real> rand_times(num_lookups);
+    for (auto& time : rand_times) {
+      time = rtime(gen);
+    }
+    Vector<Real> inc_times(rand_times);
+    std::sort(inc_times.begin(), inc_times.end());
+    for (const auto* lookup_times : {&rand_times, &inc_times}) {
+      Real sum_new = 0.;
+      Real sum_old = 0.;
+      double t0 = spray_checks::wall_time();
+      for (const Real time : *lookup_times) {
+        sum_new += jet.interpolateROI(time, mdots.dataPtr());
+      }
+      double t1 = spray_checks::wall_time();
+      for (const Real time : *lookup_times) {
+        sum_old += linear_roi(times, mdots, time);
+      }
+      double t2 = spray_checks::wall_time();
+      const double ns_new = 1.E9 * (t1 - t0) / num_lookups;
+      const double ns_old = 1.E9 * (t2 - t1) / num_lookups;
+      const std::string order =
+        (lookup_times == &rand_times) ? "random" : "increasing";
+      amrex::Print() << "  " << label << ", " << order << " times, " << nt
+                     << " samples: " << ns_new
+                     << " ns/lookup, linear search " << ns_old
+                     << " ns/lookup, speedup " << ns_old / ns_new
+                     << " (checksum " << sum_new - sum_old << ")\n";
+    }
+  }
+  return num_fail;
+}
@@ -0,0 +1,272 @@
+#include <AMReX_ParmParse.H>
+#include "PelePhysics.H"
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+// Time per parcel and substep of each way to find the skin C_p and molar
+// mass, and the largest relative difference to the full skin composition
+struct SkinTimes
+{
+  double full_ns = 0.;
+  double fill_ns = 0.;
+  double sparse_ns = 0.;
+  Real max_diff = 0.;
+};
+
+// Skin C_p and molar mass of parcel i in a gas of composition Y with NS
+// species, the last of which is the fuel. The species C_p and the fuel skin
+// mass fraction are made up, since only the work per species matters. Form 0
+// renormalizes every species as calcVaporState did before, the others use the
+// gas mixture values with a fuel correction, with (1) and without (2) the
+// skin composition that is passed to the transport properties, which is
+// stood in for by a sum
+template <int NS>
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE Real
+skin_state(
+  const int form,
+  const int i,
+  const int num_sub,
+  const Real* Y,
+  const Real* imw,
+  const Real mw_mix,
+  Real& cp_skin,
+  Real& mw_skin)
+{
+  const int fspec = NS - 1;
+  Real cp_n[NS];
+  Real Y_skin[NS];
+  Real sum = 0.;
+  for (int isub = 0; isub < num_sub; ++isub) {
+    // Species C_p at the skin temperature, as from eos.T2Cpi
+    const Real T_skin = 400. + (i % 97) + isub;
+    for (int n = 0; n < NS; ++n) {
+      cp_n[n] = 1.E7 * (1. + 0.01 * (n % 13)) + 2.E3 * (n % 5) * T_skin;
+    }
+    const Real Ysk = 0.2 + 0.05 * std::sin(0.01 * T_skin);
+    const Real renorm = (1. - Ysk) / (1. - Y[fspec]);
+    cp_skin = 0.;
+    mw_skin = 0.;
+    if (form == 0) {
+      for (int n = 0; n < NS; ++n) {
+        Y_skin[n] = 0.;
+      }
+      Y_skin[fspec] = Ysk;
+      for (int n = 0; n < NS; ++n) {
+        if (Y_skin[n] == 0.) {
+          Y_skin[n] = Y[n] * renorm;
+        }
+        cp_skin += Y_skin[n] * cp_n[n];
+        mw_skin += Y_skin[n] * imw[n];
+      }
+    } else {
+      Real cp_gas = 0.;
+      for (int n = 0; n < NS; ++n) {
+        cp_gas += Y[n] * cp_n[n];
+      }
+      cp_skin = Ysk * cp_n[fspec] + renorm * (cp_gas - Y[fspec] * cp_n[fspec]);
+      mw_skin =
+        Ysk * imw[fspec] + renorm * (1. / mw_mix - Y[fspec] * imw[fspec]);
+      if (form == 1) {
+        for (int n = 0; n < NS; ++n) {
+          Y_skin[n] = Y[n] * renorm;
+        }
+        Y_skin[fspec] = Ysk;
+      }
+    }
+    if (form < 2) {
+      for (int n = 0; n < NS; ++n) {
+        sum += Y_skin[n];
+      }
+    }
+  }
+  mw_skin = 1. / mw_skin;
+  return sum;
+}
+
+// Run form of skin_state for each parcel, with the gas composition of cell
+// i % num_cells, and return the time per parcel and substep in ns
+template <int NS>
+double
+run_skin(
+  const int form,
+  const int num_cells,
+  const int num_parcels,
+  const int num_sub,
+  const Real* Y_ptr,
+  const Real* imw_ptr,
+  const Real* mw_mix_ptr,
+  Real* out_ptr,
+  Real* sum_ptr)
+{
+  double t0 = spray_checks::wall_time();
+  amrex::ParallelFor(num_parcels, [=] AMREX_GPU_DEVICE(int i) noexcept {
+    const int c = i % num_cells;
+    sum_ptr[i] = skin_state<NS>(
+      form, i, num_sub, Y_ptr + static_cast<Long>(c) * NS, imw_ptr,
+      mw_mix_ptr[c], out_ptr[2 * i], out_ptr[2 * i + 1]);
+  });
+  Gpu::streamSynchronize();
+  return 1.E9 * (spray_checks::wall_time() - t0) /
+         (static_cast<double>(num_parcels) * num_sub);
+}
+
+// Largest relative difference of a to b over n values
+Real
+max_rel_diff(const int n, const Real* a, const Real* b)
+{
+  return Reduce::Max<Real>(n, [=] AMREX_GPU_DEVICE(int i) noexcept -> Real {
+    return std::abs(a[i] - b[i]) / std::abs(b[i]);
+  });
+}
+
+// Time the three forms of the skin state with NS species on made up gas
+// compositions, and compare the skin C_p and molar mass to the full form
+template <int NS>
+SkinTimes
+time_skin(const int num_cells, const int num_parcels, const int num_sub)
+{
+  Vector<Real> Y_gas(static_cast<Long>(num_cells) * NS);
+  Vector<Real> inv_mw(NS);
+  Vector<Real> mw_mix(num_cells);
+  for (int n = 0; n < NS; ++n) {
+    inv_mw[n] = 1. / (2. + 98. * static_cast<Real>((7 * n) % NS) / NS);
+  }
+  for (int c = 0; c < num_cells; ++c) {
+    Real* Y = &Y_gas[static_cast<Long>(c) * NS];
+    Real sum = 0.;
+    for (int n = 0; n < NS; ++n) {
+      Y[n] = 1.5 + std::sin(0.37 * c + 1.3 * n);
+      sum += Y[n];
+    }
+    Real imw = 0.;
+    for (int n = 0; n < NS; ++n) {
+      Y[n] /= sum;
+      imw += Y[n] * inv_mw[n];
+    }
+    mw_mix[c] = 1. / imw;
+  }
+  Gpu::DeviceVector<Real> d_Y(Y_gas.size());
+  Gpu::DeviceVector<Real> d_imw(NS);
+  Gpu::DeviceVector<Real> d_mw_mix(num_cells);
+  Gpu::copy(Gpu::hostToDevice, Y_gas.begin(), Y_gas.end(), d_Y.begin());
+  Gpu::copy(Gpu::hostToDevice, inv_mw.begin(), inv_mw.end(), d_imw.begin());
+  Gpu::copy(Gpu::hostToDevice, mw_mix.begin(), mw_mix.end(), d_mw_mix.begin());
+  Gpu::DeviceVector<Real> d_full(2 * num_parcels);
+  Gpu::DeviceVector<Real> d_new(2 * num_parcels);
+  Gpu::DeviceVector<Real> d_sum(num_parcels);
+
+  SkinTimes times;
+  times.full_ns = run_skin<NS>(
+    0, num_cells, num_parcels, num_sub, d_Y.data(), d_imw.data(),
+    d_mw_mix.data(), d_full.data(), d_sum.data());
+  times.fill_ns = run_skin<NS>(
+    1, num_cells, num_parcels, num_sub, d_Y.data(), d_imw.data(),
+    d_mw_mix.data(), d_new.data(), d_sum.data());
+  const int num_vals = 2 * num_parcels;
+  times.max_diff = max_rel_diff(num_vals, d_new.data(), d_full.data());
+  times.sparse_ns = run_skin<NS>(
+    2, num_cells, num_parcels, num_sub, d_Y.data(), d_imw.data(),
+    d_mw_mix.data(), d_new.data(), d_sum.data());
+  times.max_diff = amrex::max(
+    times.max_diff, max_rel_diff(num_vals, d_new.data(), d_full.data()));
+  return times;
+}
+} // namespace
+
+int
+checkSkin()
+{
+  ParmParse pp("skin");
+  // Parcels, gas cells, and substeps for the skin state timings
+  int num_parcels = 100000;
+  pp.query("num_parcels", num_parcels);
+  int num_cells = 1000;
+  pp.query("num_cells", num_cells);
+  int num_sub = 10;
+  pp.query("num_sub", num_sub);
+  // Tolerance of the skin C_p and molar mass relative to the full form
+  Real tol = 1.E-12;
+  pp.query("tol", tol);
+  // Lattice of droplets in hot air for the parcel update with the mechanism
+  // of this build, with a time step long enough to take several substeps
+  int num_part = 32;
+  pp.query("num_part", num_part);
+  Real dia = 50.E-4;
+  pp.query("dia", dia);
+  Real T_gas = 1500.;
+  pp.query("T_gas", T_gas);
+  Real dt = 1.E-3;
+  pp.query("dt", dt);
+  int num_steps = 5;
+  pp.query("num_steps", num_steps);
+
+  // The skin state of the three forms for mechanisms of about 10, 50, and
+  // 200 species
+  int num_fail = 0;
+  const std::pair<int, SkinTimes> mechs[3] = {
+    {10, time_skin<10>(num_cells, num_parcels, num_sub)},
+    {50, time_skin<50>(num_cells, num_parcels, num_sub)},
+    {200, time_skin<200>(num_cells, num_parcels, num_sub)}};
+  Real max_diff = 0.;
+  for (const auto& mech : mechs) {
+    const SkinTimes& times = mech.second;
+    amrex::Print() << "  " << mech.first << " species, ns per parcel and "
+                   << "substep: renormalized " << times.full_ns
+                   << ", gas mixture values " << times.fill_ns
+                   << ", without the skin composition " << times.sparse_ns
+                   << '\n';
+    max_diff = amrex::max(max_diff, times.max_diff);
+  }
+  num_fail += spray_checks::report(
+    "skin C_p and molar mass from the gas mixture values match the "
+    "renormalized skin, maximum relative difference " +
+      std::to_string(max_diff),
+    max_diff <= tol);
+
+  // Parcel update with the mechanism and particles.sparse_skin of this build
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const Geometry& geom = amr.Geom(0);
+  if (num_part > geom.Domain().length(0)) {
+    amrex::Abort("skin.num_part must not exceed the number of cells");
+  }
+  const SprayComps scomps = SprayCheckAmr::checkComps();
+  SprayParticleContainer::AssignSprayComps(scomps);
+  const int num_ghost = 2;
+  const BoxArray& ba = amr.boxArray(0);
+  const DistributionMapping& dm = amr.DistributionMap(0);
+  MultiFab state(ba, dm, AMREX_SPACEDIM + 3 + NUM_SPECIES, num_ghost);
+  MultiFab source(ba, dm, AMREX_SPACEDIM + 2 + NUM_SPECIES, num_ghost);
+  SprayCheckAmr::fillAirState(state, T_gas, 0.);
+  const Real spray_cfl_lev = 0.5;
+  pele::physics::transport::TransportParams<pele::physics::TransportType>
+    trans_parms;
+  trans_parms.allocate();
+  const IntVect lattice(AMREX_D_DECL(num_part, num_part, num_part));
+  const RealVect vel_part = RealVect::TheZeroVector();
+  const Real T_part = 300.;
+  const Real Y_part[SPRAY_FUEL_NUM] = {1.};
+  spc->clearParticles();
+  spc->uniformSprayInit(lattice, vel_part, dia, T_part, Y_part, 0);
+  const Long np = spc->TotalNumberOfParticles(true, false);
+  double run_time = 0.;
+  for (int step = 0; step < num_steps; ++step) {
+    source.setVal(0.);
+    double t0 = spray_checks::wall_time();
+    spc->moveKickDrift(
+      state, source, 0, dt, step * dt, false, false, num_ghost, num_ghost,
+      true, trans_parms.device_trans_parm(), spray_cfl_lev);
+    Gpu::streamSynchronize();
+    run_time += spray_checks::wall_time() - t0;
+  }
+  amrex::Print() << "  " << NUM_SPECIES << " species, particles.sparse_skin = "
+                 << SprayParticleContainer::getSprayData()->sparse_skin << ": "
+                 << 1.E9 * run_time / static_cast<double>(np * num_steps)
+                 << " ns per parcel update\n";
+  trans_parms.deallocate();
+  spc->clearParticles();
+  return num_fail;
+}
@@ -0,0 +1,176 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_FileSystem.H>
+#include <fstream>
+#include <sstream>
+#include "mechanism.H"
+#include "PelePhysics.H"
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+// Value of a column in the last line of a CSV file with a header line
+std::string
+csv_value(const std::string& file_name, const std::string& column)
+{
+  std::ifstream file(file_name);
+  std::string header;
+  std::string line;
+  std::string last;
+  std::getline(file, header);
+  while (std::getline(file, line)) {
+    last = line;
+  }
+  std::stringstream hss(header);
+  std::stringstream lss(last);
+  std::string name;
+  std::string val;
+  while (std::getline(hss, name, ',') && std::getline(lss, val, ',')) {
+    if (name == column) {
+      return val;
+    }
+  }
+  return "";
+}
+} // namespace
+
+int
+checkStats()
+{
+  ParmParse pp("stats");
+  // Lattice of parcels in each direction, at most one parcel per cell so no
+  // parcels collide; the parcels move with the gas so there is no drag
+  int num_part = 8;
+  pp.query("num_part", num_part);
+  Real dia = 50.E-4;
+  pp.query("dia", dia);
+  Real vel = 1.E3;
+  pp.query("vel", vel);
+  Real T_gas = 800.;
+  pp.query("T_gas", T_gas);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  std::unique_ptr<SprayParticleContainer> ghost_pc = amr.makeSprayContainer();
+  const Geometry& geom = amr.Geom(0);
+  const int num_cells = geom.Domain().length(0);
+  if (num_part > num_cells) {
+    amrex::Abort("stats.num_part must not exceed the number of cells");
+  }
+  std::string stats_file;
+  ParmParse("particles").query("stats_file", stats_file);
+  const SprayComps scomps = SprayCheckAmr::checkComps();
+  SprayParticleContainer::AssignSprayComps(scomps);
+
+  // A step of one cell split into three spray subcycles, with the last
+  // lattice plane of active parcels moved to the last cell so those parcels
+  // leave the domain in the second subcycle
+  const int num_ghost = 2;
+  const BoxArray& ba = amr.boxArray(0);
+  const DistributionMapping& dm = amr.DistributionMap(0);
+  MultiFab state(ba, dm, AMREX_SPACEDIM + 3 + NUM_SPECIES, num_ghost);
+  MultiFab source(ba, dm, AMREX_SPACEDIM + 2 + NUM_SPECIES, num_ghost);
+  SprayCheckAmr::fillAirState(state, T_gas, vel);
+  source.setVal(0.);
+  const Real dt = geom.CellSize(0) / vel;
+  const Real spray_cfl_lev = 1.2;
+  const int num_iter = 3;
+  pele::physics::transport::TransportParams<pele::physics::TransportType>
+    trans_parms;
+  trans_parms.allocate();
+
+  const IntVect lattice(AMREX_D_DECL(num_part, num_part, num_part));
+  const RealVect vel_part(AMREX_D_DECL(vel, 0., 0.));
+  const Real T_part = 300.;
+  const Real Y_part[SPRAY_FUEL_NUM] = {1.};
+  spc->clearParticles();
+  ghost_pc->clearParticles();
+  spc->uniformSprayInit(lattice, vel_part, dia, T_part, Y_part, 0);
+  ghost_pc->uniformSprayInit(lattice, vel_part, dia, T_part, Y_part, 0);
+  const Real shift =
+    0.5 * (geom.ProbLength(0) / static_cast<Real>(num_part) - geom.CellSize(0));
+  for (MyParIter pti(*spc, 0); pti.isValid(); ++pti) {
+    auto* pstruct = pti.GetArrayOfStructs().data();
+    amrex::ParallelFor(pti.numParticles(), [=] AMREX_GPU_DEVICE(int i) {
+      pstruct[i].pos(0) += shift;
+    });
+  }
+  spc->Redistribute();
+  // Reset the counters left by the other checks, then start a new file
+  spc->writeSprayStats(0, 0.);
+  if (!stats_file.empty() && ParallelDescriptor::IOProcessor()) {
+    FileSystem::Remove(stats_file);
+  }
+  ParallelDescriptor::Barrier();
+
+  double t0 = spray_checks::wall_time();
+  spc->moveKickDrift(
+    state, source, 0, dt, 0., false, false, num_ghost, num_ghost, true,
+    trans_parms.device_trans_parm(), spray_cfl_lev);
+  ghost_pc->moveKick(
+    state, source, 0, dt, 0., false, true, num_ghost, num_ghost,
+    trans_parms.device_trans_parm(), spray_cfl_lev);
+  Gpu::streamSynchronize();
+  double t1 = spray_checks::wall_time();
+  const SprayStats stats = spc->getSprayStats(0);
+  spc->writeSprayStats(1, dt);
+
+  const Long np = AMREX_D_TERM(
+    static_cast<Long>(num_part), *static_cast<Long>(num_part),
+    *static_cast<Long>(num_part));
+  const Long num_plane = np / static_cast<Long>(num_part);
+  amrex::Print() << "  " << np << " active and ghost parcels, "
+                 << stats.num_src_calls << " source calls, "
+                 << stats.mean_nsub() << " mean nsub, " << stats.max_nsub
+                 << " max nsub, " << stats.sum_heat_iter
+                 << " heat transfer iterations, "
+                 << 1.E9 * (t1 - t0) / static_cast<double>(2 * np)
+                 << " ns/parcel\n";
+  int num_fail = 0;
+  num_fail += spray_checks::report(
+    "active, ghost, and virtual parcel counts",
+    stats.num_active == np && stats.num_ghost == np && stats.num_virtual == 0);
+  num_fail += spray_checks::report(
+    "updates and maximum subcycles",
+    stats.num_updates == 2 && stats.max_subcycles == num_iter);
+  // Every parcel is updated in each subcycle until it leaves the domain, and
+  // ghost parcels are updated once
+  num_fail += spray_checks::report(
+    "calls to calculateSpraySource",
+    stats.num_src_calls == (num_iter + 1) * np - num_plane);
+  num_fail += spray_checks::report(
+    "substeps and heat transfer iterations",
+    stats.sum_nsub >= stats.num_src_calls && stats.max_nsub >= 1 &&
+      stats.sum_heat_iter >= 0 && stats.max_heat_iter <= stats.sum_heat_iter);
+  num_fail += spray_checks::report(
+    "parcels that left the domain",
+    stats.num_left_domain == num_plane && stats.num_dead == num_plane &&
+      stats.num_stored == np);
+  num_fail += spray_checks::report(
+    "no breakup or splash events",
+    stats.num_breakup == 0 && stats.num_splash == 0);
+  if (!stats_file.empty()) {
+    // The file is only written by the I/O rank
+    bool csv_ok = false;
+    if (ParallelDescriptor::IOProcessor()) {
+      csv_ok =
+        csv_value(stats_file, "step") == "1" &&
+        csv_value(stats_file, "num_active") == std::to_string(np) &&
+        csv_value(stats_file, "num_src_calls") ==
+          std::to_string(stats.num_src_calls) &&
+        csv_value(stats_file, "num_left_domain") == std::to_string(num_plane);
+    }
+    num_fail += spray_checks::report(
+      "counters written to " + stats_file,
+      !ParallelDescriptor::IOProcessor() || csv_ok);
+  }
+  const SprayStats reset = spc->getSprayStats(0);
+  num_fail += spray_checks::report(
+    "counters reset after they are written",
+    reset.num_updates == 0 && reset.num_src_calls == 0);
+  trans_parms.deallocate();
+  spc->clearParticles();
+  ghost_pc->clearParticles();
+  return num_fail;
+}
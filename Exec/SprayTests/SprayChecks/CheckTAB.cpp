@@ -0,0 +1,371 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_GpuContainers.H>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+#include "SBData.H"
+#include "TABBreakup.H"
+
+using namespace amrex;
+
+namespace {
+using PType = SprayParticleContainer::ParticleType;
+
+// TAB update used before the closed form advance to each breakup event, with
+// the oscillator steps written using advanceTAB() and breakupTimeTAB(): the
+// distortion is marched with substeps of 0.1 of the estimated breakup time
+// and breakup occurs at the start of the substep containing it
+AMREX_GPU_DEVICE
+AMREX_FORCE_INLINE
+Real
+substep_update_tab(
+  const Real& Reyn_d,
+  const Real& dt,
+  const Real* cBoilT,
+  const GasPhaseVals& gpv,
+  const SprayData& fdat,
+  PType& p)
+{
+  const Real C_k = 8.;
+  const Real C_d = 10.;
+  const Real C_b = 0.5;
+  const Real C_F = 1. / 3.;
+  const Real Wet = 80.;
+  const Real k2 = 2. / 9.;
+  SprayUnits SPU;
+  RealVect vel_part(AMREX_D_DECL(
+    parcelState(p, SprayComps::pstateVel),
+    parcelState(p, SprayComps::pstateVel + 1),
+    parcelState(p, SprayComps::pstateVel + 2)));
+  Real T_part = parcelState(p, SprayComps::pstateT);
+  Real dia_part = parcelState(p, SprayComps::pstateDia);
+  Real num_dens = parcelState(p, SprayComps::pstateNumDens);
+  Real rho_part = 0.;
+  Real mu_part = 0.;
+  Real Y_part[SPRAY_FUEL_NUM];
+  getLiquidY(p, fdat, Y_part);
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    Real minT = amrex::min(T_part, cBoilT[spf]);
+    rho_part += Y_part[spf] / fdat.rhoL(minT, spf);
+    mu_part += Y_part[spf] * fdat.muL(minT, spf);
+  }
+  rho_part = 1. / rho_part;
+  Real Utan_total = 0.;
+  Real sigma = fdat.sigma;
+  Real rad_part = 0.5 * dia_part;
+  Real min_rad = 4. * std::cbrt(SPU.min_mass * 3. / (4. * M_PI * rho_part));
+  if (rad_part < min_rad) {
+    return 0.;
+  }
+  RealVect diff_vel = gpv.vel_fluid - vel_part;
+  Real We_div_r = gpv.rho_fluid * diff_vel.radSquared() / sigma;
+  Real We_crit = C_k * C_b / C_F;
+  Real denom = rho_part * rad_part * rad_part;
+  Real td = 2. * denom / (C_d * mu_part);
+  Real omega2 = C_k * sigma / (denom * rad_part) - 1. / (td * td);
+  Real tbconst =
+    2. * std::sqrt(3. * rho_part / gpv.rho_fluid) / diff_vel.vectorLength();
+  if (omega2 <= 0.) {
+    parcelState(p, SprayComps::pstateBM1) = 0.;
+    parcelState(p, SprayComps::pstateBM2) = 0.;
+    return 0.;
+  }
+  Real omega = std::sqrt(omega2);
+  Real yn = parcelState(p, SprayComps::pstateBM1);
+  Real ydotn = parcelState(p, SprayComps::pstateBM2);
+  Real Reyn = Reyn_d;
+  Real C_D = 0.;
+  if (Reyn > 1000.) {
+    C_D = 0.424;
+  } else if (Reyn > 1.) {
+    C_D = 24. / Reyn * (1. + std::cbrt(Reyn * Reyn) / 6.);
+  } else if (Reyn > 0.) {
+    C_D = 24. / Reyn;
+  }
+  Real tb_estconst =
+    std::sqrt(3. * rho_part / gpv.rho_fluid) / diff_vel.vectorLength();
+  Real tb_est = 0.1 * rad_part * tb_estconst;
+  Real subdt = amrex::min(dt, tb_est);
+  Real curt = 0.;
+  while (curt < dt) {
+    Real We = We_div_r * rad_part;
+    Real Wer = We / We_crit;
+    Real A2 = std::pow(yn - Wer, 2) + ydotn * ydotn / omega2;
+    Real A = std::sqrt(A2);
+    Real ynp = yn;
+    Real ydotnp = ydotn;
+    advanceTAB(subdt, Wer, td, omega, ynp, ydotnp);
+    if (Wer + A <= 1.) {
+      yn = ynp;
+      ydotn = ydotnp;
+    } else {
+      Real tbv = breakupTimeTAB(yn, ydotn, Wer, omega, A);
+      if (tbv < subdt) {
+        const Real k1 =
+          k2 * ((std::sqrt(Wet) - 1.) * std::pow(We / Wet, 4) + 1.);
+        Real Kbr = k1 * omega;
+        if (We >= Wet) {
+          Kbr = k2 * omega * std::sqrt(We);
+        }
+        Real etheta = amrex::max(-1., amrex::min(1., 1. - 1. / Wer));
+        Real etb = std::acos(etheta) / omega;
+        Real rchild = rad_part * std::exp(-Kbr * etb);
+        num_dens *= std::pow(rad_part / rchild, 3);
+        Real rsmr = std::sqrt(std::pow(rad_part, 3) / (rchild * rchild));
+        Real AE2 = 3. * (1. - rad_part / rsmr + 5. * C_D * We / 72.) * omega2;
+        Utan_total += std::sqrt(AE2) * C_b * rad_part;
+        Reyn = Reyn * rchild / rad_part;
+        if (Reyn > 1000.) {
+          C_D = 0.424;
+        } else if (Reyn > 1.) {
+          C_D = 24. / Reyn * (1. + std::cbrt(Reyn * Reyn) / 6.);
+        } else if (Reyn > 0.) {
+          C_D = 24. / Reyn;
+        }
+        rad_part = rchild;
+        yn = 0.;
+        ydotn = 0.;
+        tb_est = rad_part * tbconst;
+        subdt = amrex::min(dt, 0.1 * tb_est);
+        denom = rho_part * rad_part * rad_part;
+        td = 2. * denom / (C_d * mu_part);
+        omega2 = C_k * sigma / (denom * rad_part) - 1. / (td * td);
+        if (omega2 <= 0.) {
+          parcelState(p, SprayComps::pstateDia) = 2. * rad_part;
+          parcelState(p, SprayComps::pstateNumDens) = num_dens;
+          parcelState(p, SprayComps::pstateBM1) = 0.;
+          parcelState(p, SprayComps::pstateBM2) = 0.;
+          return Utan_total;
+        }
+        omega = std::sqrt(omega2);
+      } else {
+        yn = ynp;
+        ydotn = ydotnp;
+      }
+    }
+    if (curt + subdt > dt) {
+      subdt = dt - curt;
+    }
+    curt += subdt;
+  }
+  parcelState(p, SprayComps::pstateDia) = 2. * rad_part;
+  parcelState(p, SprayComps::pstateNumDens) = num_dens;
+  parcelState(p, SprayComps::pstateBM1) = yn;
+  parcelState(p, SprayComps::pstateBM2) = ydotn;
+  return Utan_total;
+}
+
+// Undistorted parcel at rest
+AMREX_GPU_HOST_DEVICE
+AMREX_FORCE_INLINE
+PType
+tab_parcel(const Real& dia, const Real& T_part, const SprayData& fdat)
+{
+  PType p;
+  p.id() = 1;
+  p.cpu() = 0;
+  for (int slot = 0; slot < NSR_SPR; ++slot) {
+    p.rdata(slot) = 0.;
+  }
+  parcelState(p, SprayComps::pstateT) = T_part;
+  parcelState(p, SprayComps::pstateDia) = dia;
+#ifdef SPRAY_USE_CTM
+  parcelState(p, SprayComps::pstateCTM) = fdat.ctm.theta0;
+  parcelState(p, SprayComps::pstateCTM + 1) = fdat.ctm.psi0;
+#else
+  amrex::ignore_unused(fdat);
+  parcelState(p, SprayComps::pstateY) = 1.;
+#endif
+  parcelState(p, SprayComps::pstateNumDens) = 1.;
+  parcelState(p, SprayComps::pstateN0) = 1.;
+  return p;
+}
+
+// Exact time the distortion of an undistorted droplet first reaches 1, from
+// the closed form solution sampled at a small fraction of the period and
+// bisected
+AMREX_GPU_DEVICE
+AMREX_FORCE_INLINE
+Real
+exact_breakup_time(const Real& Wer, const Real& td, const Real& omega)
+{
+  auto distortion = [=](const Real& t) {
+    Real yn = 0.;
+    Real ydotn = 0.;
+    advanceTAB(t, Wer, td, omega, yn, ydotn);
+    return yn;
+  };
+  const Real tstep = 2.E-3 * M_PI / omega;
+  Real tlo = 0.;
+  int nstep = 0;
+  while (distortion(tlo + tstep) < 1.) {
+    tlo += tstep;
+    if (++nstep > 1000000) {
+      return -1.;
+    }
+  }
+  Real thi = tlo + tstep;
+  for (int iter = 0; iter < 60; ++iter) {
+    const Real mid = 0.5 * (tlo + thi);
+    if (distortion(mid) < 1.) {
+      tlo = mid;
+    } else {
+      thi = mid;
+    }
+  }
+  return thi;
+}
+
+// Smallest time step over which the update breaks up an undistorted parcel,
+// found by bisection; returns -1 if thi is too short
+template <typename UpdateFunc>
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE Real
+breakup_time(
+  const Real& dia,
+  const Real& T_part,
+  const Real& thi,
+  const GasPhaseVals& gpv,
+  const SprayData& fdat,
+  UpdateFunc const& update)
+{
+  const Real cBoilT[SPRAY_FUEL_NUM] = {1.E4};
+  const Real Reyn = 100.;
+  auto breaks = [&](const Real& dt) {
+    PType p = tab_parcel(dia, T_part, fdat);
+    update(Reyn, dt, cBoilT, gpv, fdat, p);
+    return parcelState(p, SprayComps::pstateDia) < dia;
+  };
+  if (!breaks(thi)) {
+    return -1.;
+  }
+  Real lo = 0.;
+  Real hi = thi;
+  for (int iter = 0; iter < 60; ++iter) {
+    const Real mid = 0.5 * (lo + hi);
+    if (breaks(mid)) {
+      hi = mid;
+    } else {
+      lo = mid;
+    }
+  }
+  return hi;
+}
+} // namespace
+
+int
+checkTAB()
+{
+  ParmParse pp("tab");
+  // Weber numbers relative to the critical Weber number of TAB
+  Vector<Real> wer_list = {1.1, 1.5, 3., 10., 50.};
+  pp.queryarr("wer", wer_list);
+  Real dia = 50.E-4;
+  pp.query("dia", dia);
+  Real rho_gas = 0.02;
+  pp.query("rho_gas", rho_gas);
+  // Maximum breakup time error relative to the oscillation period
+  Real tol = 1.E-3;
+  pp.query("tol", tol);
+  // Parcels and time step, in breakup times, used for the timings
+  int num_parcels = 100000;
+  pp.query("num_parcels", num_parcels);
+  Real dt_factor = 10.;
+  pp.query("dt_factor", dt_factor);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const SprayData* fdat = SprayParticleContainer::getSprayData();
+  Gpu::AsyncArray<SprayData> fdat_arr(fdat, 1);
+  const SprayData* d_fdat = fdat_arr.data();
+  const Real T_part = 300.;
+  const Real rho_part = fdat->rhoL(T_part, 0);
+  const Real mu_part = fdat->muL(T_part, 0);
+  const Real sigma = fdat->sigma;
+  const Real rad = 0.5 * dia;
+  // Oscillator constants used by updateBreakupTAB
+  const Real We_crit = 12.;
+  const Real td = 2. * rho_part * rad * rad / (10. * mu_part);
+  const Real omega =
+    std::sqrt(8. * sigma / (rho_part * rad * rad * rad) - 1. / (td * td));
+
+  int num_fail = 0;
+  for (const Real Wer : wer_list) {
+    GasPhaseVals gpv;
+    gpv.rho_fluid = rho_gas;
+    gpv.vel_fluid = RealVect(AMREX_D_DECL(
+      std::sqrt(Wer * We_crit * sigma / (rho_gas * rad)), 0., 0.));
+    // Exact breakup time and the breakup times of both updates
+    Gpu::DeviceVector<Real> d_times(3);
+    Real* times = d_times.data();
+    amrex::ParallelFor(1, [=] AMREX_GPU_DEVICE(int) noexcept {
+      times[2] = exact_breakup_time(Wer, td, omega);
+      const Real t_max = 4. * times[2];
+      times[0] = breakup_time(
+        dia, T_part, t_max, gpv, *d_fdat,
+        [](
+          const Real& Reyn, const Real& dt, const Real* cBoilT,
+          const GasPhaseVals& g, const SprayData& fd, PType& p) {
+          return updateBreakupTAB(Reyn, dt, cBoilT, g, fd, p);
+        });
+      times[1] = breakup_time(
+        dia, T_part, t_max, gpv, *d_fdat,
+        [](
+          const Real& Reyn, const Real& dt, const Real* cBoilT,
+          const GasPhaseVals& g, const SprayData& fd, PType& p) {
+          return substep_update_tab(Reyn, dt, cBoilT, g, fd, p);
+        });
+    });
+    Vector<Real> h_times(3);
+    Gpu::copy(
+      Gpu::deviceToHost, d_times.begin(), d_times.end(), h_times.begin());
+    const Real t_exact = h_times[2];
+    const Real period = 2. * M_PI / omega;
+    const Real err_new = std::abs(h_times[0] - t_exact) / period;
+    const Real err_old = std::abs(h_times[1] - t_exact) / period;
+
+    // Time both updates over dt_factor breakup times, where several breakup
+    // events can occur
+    const Real dt = dt_factor * t_exact;
+    Gpu::DeviceVector<Real> d_dia(2 * num_parcels);
+    Real* dia_out = d_dia.data();
+    Vector<double> run_time(2);
+    for (int model = 0; model < 2; ++model) {
+      double t0 = spray_checks::wall_time();
+      amrex::ParallelFor(num_parcels, [=] AMREX_GPU_DEVICE(int i) noexcept {
+        const Real cBoilT[SPRAY_FUEL_NUM] = {1.E4};
+        PType p = tab_parcel(dia, T_part, *d_fdat);
+        if (model == 0) {
+          updateBreakupTAB(100., dt, cBoilT, gpv, *d_fdat, p);
+        } else {
+          substep_update_tab(100., dt, cBoilT, gpv, *d_fdat, p);
+        }
+        dia_out[model * num_parcels + i] =
+          parcelState(p, SprayComps::pstateDia);
+      });
+      Gpu::streamSynchronize();
+      run_time[model] = spray_checks::wall_time() - t0;
+    }
+    Vector<Real> h_dia(2);
+    Gpu::copy(
+      Gpu::deviceToHost, d_dia.begin(), d_dia.begin() + 1, h_dia.begin());
+    Gpu::copy(
+      Gpu::deviceToHost, d_dia.begin() + num_parcels,
+      d_dia.begin() + num_parcels + 1, h_dia.begin() + 1);
+
+    const std::string label = "We/We_crit " + std::to_string(Wer);
+    amrex::Print() << "  " << label << ": exact breakup time " << t_exact
+                   << " s, closed form " << h_times[0] << " s, substepped "
+                   << h_times[1] << " s; errors " << err_new << " and "
+                   << err_old << " periods\n";
+    amrex::Print() << "  " << label << ", dt " << dt << " s: "
+                   << 1.E9 * run_time[0] / num_parcels
+                   << " ns/parcel closed form, "
+                   << 1.E9 * run_time[1] / num_parcels
+                   << " ns/parcel substepped, final diameters " << h_dia[0]
+                   << " and " << h_dia[1] << '\n';
+    num_fail += spray_checks::report(
+      label + " closed form breakup time within " + std::to_string(tol) +
+        " periods of the exact time",
+      t_exact > 0. && h_times[0] > 0. && err_new <= tol);
+  }
+  return num_fail;
+}
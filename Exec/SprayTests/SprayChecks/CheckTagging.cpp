@@ -0,0 +1,186 @@
+#include <AMReX_ParmParse.H>
+#include <AMReX_TagBox.H>
+#include <AMReX_iMultiFab.H>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+// Number of valid parcels in each cell, counted independently of the derived
+// spray variables
+void
+count_parcels(SprayParticleContainer& spc, const Geometry& geom, iMultiFab& cnt)
+{
+  cnt.setVal(0);
+  const auto plo = geom.ProbLoArray();
+  const auto dxi = geom.InvCellSizeArray();
+  for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+    const auto* pstruct = pti.GetArrayOfStructs().data();
+    auto const& cnt_arr = cnt.array(pti);
+    amrex::ParallelFor(pti.numParticles(), [=] AMREX_GPU_DEVICE(int i) {
+      const auto& p = pstruct[i];
+      if (p.id() > 0) {
+        IntVect iv;
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          iv[dir] = static_cast<int>(
+            amrex::Math::floor((p.pos(dir) - plo[dir]) * dxi[dir]));
+        }
+        Gpu::Atomic::AddNoRet(&cnt_arr(iv), 1);
+      }
+    });
+  }
+}
+
+// Tagged cells, tagged cells that differ from the expected tags, parcels in
+// the tagged cells, and cells holding parcels
+struct TagCounts
+{
+  Long num_tagged = 0;
+  Long num_wrong = 0;
+  Long num_parcels = 0;
+  Long num_spray_cells = 0;
+};
+
+TagCounts
+tag_counts(const TagBoxArray& tags, const iMultiFab& cnt, const int min_count)
+{
+  ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+  ReduceData<Long, Long, Long, Long> reduce_data(reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+  const char tagval = TagBox::SET;
+  for (MFIter mfi(tags); mfi.isValid(); ++mfi) {
+    auto const& tag_arr = tags.const_array(mfi);
+    auto const& cnt_arr = cnt.const_array(mfi);
+    reduce_op.eval(
+      mfi.validbox(), reduce_data,
+      [=] AMREX_GPU_DEVICE(int i, int j, int k) -> ReduceTuple {
+        const bool tagged = (tag_arr(i, j, k) == tagval);
+        const int num = cnt_arr(i, j, k);
+        const bool expected = (num > min_count);
+        return {
+          tagged ? 1 : 0, (tagged != expected) ? 1 : 0, tagged ? num : 0,
+          (num > 0) ? 1 : 0};
+      });
+  }
+  ReduceTuple hv = reduce_data.value();
+  TagCounts tc;
+  tc.num_tagged = amrex::get<0>(hv);
+  tc.num_wrong = amrex::get<1>(hv);
+  tc.num_parcels = amrex::get<2>(hv);
+  tc.num_spray_cells = amrex::get<3>(hv);
+  ParallelDescriptor::ReduceLongSum(tc.num_tagged);
+  ParallelDescriptor::ReduceLongSum(tc.num_wrong);
+  ParallelDescriptor::ReduceLongSum(tc.num_parcels);
+  ParallelDescriptor::ReduceLongSum(tc.num_spray_cells);
+  return tc;
+}
+} // namespace
+
+int
+checkTagging()
+{
+  ParmParse pp("tag");
+  // Jet of the jet_spray case scaled to the check mesh, injecting along y
+  // from the center of the lower y face
+  Real jet_dia = 0.05;
+  pp.query("jet_dia", jet_dia);
+  Real spread_angle = 21.;
+  pp.query("spread_angle", spread_angle);
+  Real jet_vel = 1.E4;
+  pp.query("jet_vel", jet_vel);
+  int parcels_per_step = 200;
+  pp.query("parcels_per_step", parcels_per_step);
+  // Number of steps, each injecting and then moving the parcels about a cell
+  int num_steps = 40;
+  pp.query("num_steps", num_steps);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const Geometry& geom = amr.Geom(0);
+  const SprayData* fdat = SprayParticleContainer::getSprayData();
+  ParmParse ppp("particles");
+  Real tag_num_parcels = -1.;
+  ppp.query("tag_num_parcels", tag_num_parcels);
+  int tag_clear_empty = 0;
+  ppp.query("tag_clear_empty", tag_clear_empty);
+  if (tag_num_parcels < 0. || tag_clear_empty == 0) {
+    amrex::Abort(
+      "tag check requires particles.tag_num_parcels >= 0 and "
+      "particles.tag_clear_empty = 1");
+  }
+  const Real T_jet = 300.;
+  const GpuArray<Real, SPRAY_FUEL_NUM> Y_jet = {{1.}};
+  Real rho_part = 0.;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    rho_part += Y_jet[spf] / fdat->rhoL(T_jet, spf);
+  }
+  rho_part = 1. / rho_part;
+  Real dia = 0.;
+  ParmParse("spray").get("diameter", dia);
+  const Real dt = geom.CellSize(1) / jet_vel;
+  const Real mdot = static_cast<Real>(parcels_per_step) * M_PI / 6. *
+                    rho_part * std::pow(dia, 3) / dt;
+  RealVect cent(AMREX_D_DECL(
+    0.5 * (geom.ProbLo(0) + geom.ProbHi(0)), geom.ProbLo(1),
+    0.5 * (geom.ProbLo(2) + geom.ProbHi(2))));
+  const RealVect norm(AMREX_D_DECL(0., 1., 0.));
+  SprayJet jet(
+    "jet_tag", geom, cent, norm, spread_angle, jet_dia, jet_vel, mdot, T_jet,
+    Y_jet, "Uniform");
+  jet.set_num_ppp(1.);
+
+  // Inject and move the parcels ballistically to form the spray cone
+  spc->clearParticles();
+  Real time = 0.;
+  for (int step = 0; step < num_steps; ++step) {
+    spc->sprayInjection(time, &jet, dt, 0);
+    for (MyParIter pti(*spc, 0); pti.isValid(); ++pti) {
+      auto* pstruct = pti.GetArrayOfStructs().data();
+      amrex::ParallelFor(pti.numParticles(), [=] AMREX_GPU_DEVICE(int i) {
+        auto& p = pstruct[i];
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          p.pos(dir) += dt * parcelState(p, SprayComps::pstateVel + dir);
+        }
+      });
+    }
+    spc->Redistribute();
+    time += dt;
+  }
+  const Long num_parcels = spc->TotalNumberOfParticles(true, false);
+
+  const BoxArray& ba = amr.boxArray(0);
+  const DistributionMapping& dm = amr.DistributionMap(0);
+  iMultiFab cnt(ba, dm, 1, 0);
+  count_parcels(*spc, geom, cnt);
+  MultiFab mf_var(
+    spc->ParticleBoxArray(0), spc->ParticleDistributionMap(0),
+    SprayParticleContainer::NumDeriveVars(), 0);
+  TagBoxArray tags(ba, dm, 0);
+  const int min_count = static_cast<int>(std::floor(tag_num_parcels));
+  int num_fail = 0;
+  // Without gas phase tags, the cells with more parcels than the threshold
+  // are tagged; when every cell is already tagged, the cells without spray
+  // are cleared
+  for (const bool pre_tag : {false, true}) {
+    tags.setVal(pre_tag ? TagBox::SET : TagBox::CLEAR);
+    double t0 = spray_checks::wall_time();
+    spc->tagSprayCells(tags, mf_var, 0);
+    Gpu::streamSynchronize();
+    double t1 = spray_checks::wall_time();
+    const TagCounts tc = tag_counts(tags, cnt, pre_tag ? 0 : min_count);
+    const std::string label =
+      pre_tag ? "all cells pre-tagged" : "no cells pre-tagged";
+    amrex::Print() << "  " << label << ": " << tc.num_tagged << " of "
+                   << ba.numPts() << " cells tagged, " << tc.num_parcels
+                   << " of " << num_parcels << " parcels in tagged cells, "
+                   << tc.num_spray_cells << " cells with parcels, "
+                   << AMREX_D_TERM(2, *2, *2) * tc.num_tagged
+                   << " cells on the refined level, " << t1 - t0 << " s\n";
+    num_fail += spray_checks::report(
+      label + ", tags match the parcel counts",
+      tc.num_tagged > 0 && tc.num_wrong == 0);
+  }
+  spc->clearParticles();
+  return num_fail;
+}
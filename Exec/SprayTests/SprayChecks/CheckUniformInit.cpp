@@ -0,0 +1,142 @@
+#include <AMReX_ParmParse.H>
+#include <algorithm>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+using namespace amrex;
+
+namespace {
+// Lattice index of each parcel, whether its cell is outside the box of its
+// tile, and its ID, for the parcels on this rank
+void
+parcel_indices(
+  SprayParticleContainer& spc,
+  const Geometry& geom,
+  const IntVect& num_part,
+  Vector<Long>& lat_indx,
+  Vector<Long>& ids,
+  Long& num_bad)
+{
+  const auto plo = geom.ProbLoArray();
+  const auto dxi = geom.InvCellSizeArray();
+  const IntVect dom_lo = geom.Domain().smallEnd();
+  const RealVect dxi_part(AMREX_D_DECL(
+    Real(num_part[0]) / geom.ProbLength(0),
+    Real(num_part[1]) / geom.ProbLength(1),
+    Real(num_part[2]) / geom.ProbLength(2)));
+  const Box lat_box(IntVect::TheZeroVector(), num_part - 1);
+  lat_indx.clear();
+  ids.clear();
+  num_bad = 0;
+  for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+    const Box tile_box = pti.tilebox();
+    const auto* pstruct = pti.GetArrayOfStructs().data();
+    const int np = pti.numParticles();
+    Gpu::DeviceVector<Long> d_indx(np);
+    Gpu::DeviceVector<Long> d_ids(np);
+    Long* indx_ptr = d_indx.data();
+    Long* ids_ptr = d_ids.data();
+    num_bad += Reduce::Sum<Long>(
+      np, [=] AMREX_GPU_DEVICE(int i) noexcept -> Long {
+        const auto& p = pstruct[i];
+        IntVect cell;
+        IntVect lat;
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          const Real rpos = p.pos(dir) - plo[dir];
+          cell[dir] =
+            static_cast<int>(amrex::Math::floor(rpos * dxi[dir])) + dom_lo[dir];
+          lat[dir] = static_cast<int>(amrex::Math::floor(rpos * dxi_part[dir]));
+        }
+        indx_ptr[i] = lat_box.contains(lat) ? lat_box.index(lat) : -1;
+        ids_ptr[i] = p.id();
+        return tile_box.contains(cell) ? 0 : 1;
+      });
+    const auto old_size = lat_indx.size();
+    lat_indx.resize(old_size + np);
+    ids.resize(old_size + np);
+    Gpu::copy(
+      Gpu::deviceToHost, d_indx.begin(), d_indx.end(),
+      lat_indx.begin() + old_size);
+    Gpu::copy(
+      Gpu::deviceToHost, d_ids.begin(), d_ids.end(), ids.begin() + old_size);
+  }
+}
+} // namespace
+
+int
+checkUniformInit()
+{
+  ParmParse pp("init");
+  // Number of lattice parcels in each direction for each initialization
+  Vector<int> num_parts = {50, 100};
+  pp.queryarr("num_part", num_parts);
+
+  SprayCheckAmr amr;
+  std::unique_ptr<SprayParticleContainer> spc = amr.makeSprayContainer();
+  const Geometry& geom = amr.Geom(0);
+  const Real T_part = 300.;
+  const Real Y_part[SPRAY_FUEL_NUM] = {1.};
+  const Real dia = 50.E-4;
+  int num_fail = 0;
+  for (const int num : num_parts) {
+    const IntVect num_part(AMREX_D_DECL(num, num, num));
+    const Long num_total = AMREX_D_TERM(
+      static_cast<Long>(num), *static_cast<Long>(num), *static_cast<Long>(num));
+    spc->clearParticles();
+    ParallelDescriptor::Barrier();
+    double t0 = spray_checks::wall_time();
+    spc->uniformSprayInit(
+      num_part, RealVect::TheZeroVector(), dia, T_part, Y_part, 0);
+    Gpu::streamSynchronize();
+    double run_time = spray_checks::wall_time() - t0;
+    ParallelDescriptor::ReduceRealMax(run_time);
+    // Minimum, maximum, and total bytes of parcel storage over the ranks
+    const auto bytes = spc->ByteSpread();
+
+    Vector<Long> lat_indx;
+    Vector<Long> ids;
+    Long num_bad = 0;
+    parcel_indices(*spc, geom, num_part, lat_indx, ids, num_bad);
+    ParallelDescriptor::ReduceLongSum(num_bad);
+    // Each lattice site must hold exactly one parcel over all ranks
+    Vector<int> hits(num_total, 0);
+    Long num_outside = 0;
+    for (const Long indx : lat_indx) {
+      if (indx < 0) {
+        num_outside++;
+      } else {
+        hits[indx]++;
+      }
+    }
+    ParallelDescriptor::ReduceLongSum(num_outside);
+    ParallelDescriptor::ReduceIntSum(hits.data(), static_cast<int>(num_total));
+    const bool all_sites =
+      std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; });
+    // IDs hold the creating rank in cpu(), so they are unique if they are
+    // unique on each rank
+    std::sort(ids.begin(), ids.end());
+    int dup_ids =
+      (std::adjacent_find(ids.begin(), ids.end()) != ids.end() ||
+       (!ids.empty() && ids.front() <= 0))
+        ? 1
+        : 0;
+    ParallelDescriptor::ReduceIntMax(dup_ids);
+    const Long num_parcels = spc->TotalNumberOfParticles(true, false);
+    amrex::Print() << "  " << num_parcels << " parcels on "
+                   << ParallelDescriptor::NProcs() << " ranks in " << run_time
+                   << " s, " << 1.E9 * run_time / static_cast<double>(num_total)
+                   << " ns/parcel; parcel bytes per rank min " << bytes[0]
+                   << ", max " << bytes[1] << ", total " << bytes[2] << '\n';
+    const std::string label = std::to_string(num) + "^" +
+                              std::to_string(AMREX_SPACEDIM) + " lattice";
+    num_fail += spray_checks::report(
+      label + ", one parcel at each site",
+      num_parcels == num_total && num_outside == 0 && all_sites);
+    num_fail += spray_checks::report(
+      label + ", parcels in the tile of their cell without redistribution",
+      num_bad == 0);
+    num_fail += spray_checks::report(label + ", unique IDs", dup_ids == 0);
+  }
+  spc->clearParticles();
+  return num_fail;
+}
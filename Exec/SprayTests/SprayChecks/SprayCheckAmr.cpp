@@ -0,0 +1,73 @@
+#include "mechanism.H"
+#include "PelePhysics.H"
+#include "SprayCheckAmr.H"
+
+bool SprayCheckAmr::m_spraySetup = false;
+
+std::unique_ptr<SprayParticleContainer>
+SprayCheckAmr::makeSprayContainer()
+{
+  if (!m_spraySetup) {
+    int particle_verbose = 0;
+    SprayParticleContainer::readSprayParams(particle_verbose);
+    const amrex::Real body_force[AMREX_SPACEDIM] = {AMREX_D_DECL(0., 0., 0.)};
+    SprayParticleContainer::spraySetup(body_force);
+    m_spraySetup = true;
+  }
+  return std::make_unique<SprayParticleContainer>(this, &m_physBC);
+}
+
+void
+SprayCheckAmr::cleanUp()
+{
+  if (m_spraySetup) {
+    SprayParticleContainer::SprayCleanUp();
+    m_spraySetup = false;
+  }
+}
+
+SprayComps
+SprayCheckAmr::checkComps()
+{
+  SprayComps scomps;
+  scomps.rhoIndx = 0;
+  scomps.momIndx = 1;
+  scomps.engIndx = AMREX_SPACEDIM + 1;
+  scomps.utempIndx = AMREX_SPACEDIM + 2;
+  scomps.specIndx = AMREX_SPACEDIM + 3;
+  scomps.rhoSrcIndx = 0;
+  scomps.momSrcIndx = 1;
+  scomps.engSrcIndx = AMREX_SPACEDIM + 1;
+  scomps.specSrcIndx = AMREX_SPACEDIM + 2;
+  return scomps;
+}
+
+void
+SprayCheckAmr::fillAirState(
+  amrex::MultiFab& state, const amrex::Real T_gas, const amrex::Real vel)
+{
+  const SprayComps scomps = checkComps();
+  auto eos = pele::physics::PhysicsType::eos();
+  amrex::GpuArray<amrex::Real, NUM_SPECIES> Y_gas = {{0.}};
+  Y_gas[O2_ID] = 0.233;
+  Y_gas[N2_ID] = 0.767;
+  const amrex::Real p_gas = 1.01325E6;
+  amrex::Real rho = 0.;
+  amrex::Real eint = 0.;
+  eos.PYT2RE(p_gas, Y_gas.data(), T_gas, rho, eint);
+  for (amrex::MFIter mfi(state); mfi.isValid(); ++mfi) {
+    auto const& sarr = state.array(mfi);
+    amrex::ParallelFor(
+      mfi.fabbox(), [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+        sarr(i, j, k, scomps.rhoIndx) = rho;
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          sarr(i, j, k, scomps.momIndx + dir) = (dir == 0) ? rho * vel : 0.;
+        }
+        sarr(i, j, k, scomps.engIndx) = rho * (eint + 0.5 * vel * vel);
+        sarr(i, j, k, scomps.utempIndx) = T_gas;
+        for (int n = 0; n < NUM_SPECIES; ++n) {
+          sarr(i, j, k, scomps.specIndx + n) = rho * Y_gas[n];
+        }
+      });
+  }
+}
@@ -0,0 +1,55 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <functional>
+#include <map>
+#include "SprayChecks.H"
+#include "SprayCheckAmr.H"
+
+// Runs the spray checks listed in checks, or all of them if checks is not
+// given, and returns a nonzero exit code if any test fails
+int
+main(int argc, char* argv[])
+{
+  amrex::Initialize(argc, argv);
+  int num_fail = 0;
+  {
+    const std::map<std::string, std::function<int()>> all_checks = {
+      {"roi", checkROI},
+      {"dist", checkDistributions},
+      {"inject", checkInjection},
+      {"merge", checkMerge},
+      {"collide", checkCollision},
+      {"tab", checkTAB},
+      {"tag", checkTagging},
+      {"stats", checkStats},
+      {"heat", checkHeatCoeff},
+      {"init", checkUniformInit},
+      {"load", checkLoad},
+      {"boil", checkBoilT},
+      {"ctm", checkCTM},
+      {"prec", checkPrecision},
+      {"skin", checkSkin},
+      {"prop", checkPropTable}};
+    amrex::ParmParse pp;
+    amrex::Vector<std::string> checks;
+    pp.queryarr("checks", checks);
+    if (checks.empty()) {
+      for (const auto& check : all_checks) {
+        checks.push_back(check.first);
+      }
+    }
+    for (const auto& name : checks) {
+      auto it = all_checks.find(name);
+      if (it == all_checks.end()) {
+        amrex::Abort("Unknown spray check " + name);
+      }
+      amrex::Print() << "Spray check " << name << '\n';
+      num_fail += it->second();
+    }
+    SprayCheckAmr::cleanUp();
+    amrex::Print() << "Spray checks: " << num_fail << " failed tests"
+                   << std::endl;
+  }
+  amrex::Finalize();
+  return (num_fail > 0) ? 1 : 0;
+}
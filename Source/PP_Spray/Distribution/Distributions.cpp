@@ -2,17 +2,61 @@
 #include "AMReX_Random.H"
 #include "AMReX_ParmParse.H"
 
+void
+DistBase::read_table_size(const std::string& a_prefix)
+{
+  amrex::ParmParse pp(a_prefix);
+  pp.query("dist_table_size", m_tableSize);
+  if (m_tableSize < 0 || m_tableSize == 1) {
+    amrex::Abort(a_prefix + ".dist_table_size must be 0 or greater than 1");
+  }
+}
+
+void
+DistBase::build_table(const int num_vals)
+{
+  m_hTable.clear();
+  m_dTable.clear();
+  if (num_vals <= 0) {
+    return;
+  }
+  // The table only covers the interior of the CDF, the tails are sampled
+  // from the exact inverse CDF by DistSampler
+  const amrex::Real dr = 1. / static_cast<amrex::Real>(num_vals + 1);
+  m_hTable.resize(num_vals);
+  for (int i = 0; i < num_vals; ++i) {
+    m_hTable[i] = quantile(static_cast<amrex::Real>(i + 1) * dr);
+  }
+  m_dTable.resize(num_vals);
+  amrex::Gpu::copy(
+    amrex::Gpu::hostToDevice, m_hTable.begin(), m_hTable.end(),
+    m_dTable.begin());
+}
+
+amrex::Real
+DistBase::sample_table() const
+{
+  DistSampler host_sampler{
+    m_hTable.dataPtr(), static_cast<int>(m_hTable.size()), m_kind, m_p0, m_p1};
+  return host_sampler.sample(amrex::Random());
+}
+
 void
 Uniform::init(const std::string& a_prefix)
 {
   amrex::ParmParse pp(a_prefix);
   pp.get("diameter", m_diam);
+  read_table_size(a_prefix);
+  init(m_diam);
 }
 
 void
 Uniform::init(const amrex::Real& diam)
 {
   m_diam = diam;
+  set_quantile(DistKind::Uniform, m_diam);
+  // The table is always built since it only holds a single value
+  build_table(2);
 }
 
 amrex::Real
@@ -31,8 +75,12 @@ void
 Normal::init(const std::string& a_prefix)
 {
   amrex::ParmParse pp(a_prefix);
-  pp.get("mean_dia", m_mean);
-  pp.get("std_dev", m_std);
+  amrex::Real mean;
+  amrex::Real std;
+  pp.get("mean_dia", mean);
+  pp.get("std_dev", std);
+  read_table_size(a_prefix);
+  init(mean, std);
 }
 
 void
@@ -40,11 +88,16 @@ Normal::init(const amrex::Real& mean, const amrex::Real& std)
 {
   m_mean = mean;
   m_std = std;
+  set_quantile(DistKind::Normal, m_mean, m_std);
+  build_table(m_tableSize);
 }
 
 amrex::Real
 Normal::get_dia()
 {
+  if (has_table()) {
+    return sample_table();
+  }
   return amrex::RandomNormal(m_mean, m_std);
 }
 
@@ -61,6 +114,8 @@ LogNormal::init(const amrex::Real& mean, const amrex::Real& std)
   m_log_mean = 2. * std::log(mean) - 0.5 * std::log(std * std + mean * mean);
   m_log_std = std::sqrt(
     amrex::max(-2. * std::log(mean) + std::log(std * std + mean * mean), 0.));
+  set_quantile(DistKind::LogNormal, m_log_mean, m_log_std);
+  build_table(m_tableSize);
 }
 void
 LogNormal::init(const std::string& a_prefix)
@@ -70,12 +125,16 @@ LogNormal::init(const std::string& a_prefix)
   amrex::Real std;
   pp.get("mean_dia", mean);
   pp.get("std_dev", std);
+  read_table_size(a_prefix);
   init(mean, std);
 }
 
 amrex::Real
 LogNormal::get_dia()
 {
+  if (has_table()) {
+    return sample_table();
+  }
   return std::exp(amrex::RandomNormal(m_log_mean, m_log_std));
 }
 
@@ -89,8 +148,12 @@ void
 Weibull::init(const std::string& a_prefix)
 {
   amrex::ParmParse pp(a_prefix);
-  pp.get("mean_dia", m_mean);
-  pp.get("k", m_k);
+  amrex::Real mean;
+  amrex::Real k;
+  pp.get("mean_dia", mean);
+  pp.get("k", k);
+  read_table_size(a_prefix);
+  init(mean, k);
 }
 
 void
@@ -98,11 +161,16 @@ Weibull::init(const amrex::Real& mean, const amrex::Real& k)
 {
   m_mean = mean;
   m_k = k;
+  set_quantile(DistKind::Weibull, m_mean, m_k);
+  build_table(m_tableSize);
 }
 
 amrex::Real
 Weibull::get_dia()
 {
+  if (has_table()) {
+    return sample_table();
+  }
   amrex::Real fact = -std::log(1. - amrex::Random());
   return m_mean * std::pow(fact, 1. / m_k);
 }
@@ -119,6 +187,7 @@ ChiSquared::init(const std::string& a_prefix)
   amrex::ParmParse pp(a_prefix);
   amrex::Real d32 = 0.;
   pp.get("d32", d32);
+  read_table_size(a_prefix);
   init(d32);
 }
 
@@ -126,6 +195,8 @@ void
 ChiSquared::init(const amrex::Real& d32)
 {
   m_d32 = d32;
+  set_quantile(DistKind::ChiSquared, m_d32);
+  build_table(m_tableSize);
   amrex::Real xiend = 12.;
   amrex::Real dxi = xiend / 100.;
   amrex::Real rend =
@@ -141,6 +212,9 @@ ChiSquared::init(const amrex::Real& d32)
 amrex::Real
 ChiSquared::get_dia()
 {
+  if (has_table()) {
+    return sample_table();
+  }
   amrex::Real dmean = m_d32 / 3.;
   amrex::Real dxi = 12. / 100.;
   amrex::Real fact = amrex::Random();
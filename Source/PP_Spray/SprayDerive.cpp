@@ -1,5 +1,7 @@
 
 #include "SprayParticles.H"
+#include "AhamedSplash.H"
+#include <algorithm>
 #ifdef AMREX_USE_EB
 #include <AMReX_EBFArrayBox.H>
 #endif
@@ -45,6 +47,11 @@ SprayParticleContainer::computeDerivedVars(
   const int temp_indx = wfm_indx + 1;
   const int nump_indx = temp_indx + 1;
   const int vel_indx = nump_indx + 1;
+  Long derive_bytes = 0;
+  for (MFIter mfi(mf_var); mfi.isValid(); ++mfi) {
+    derive_bytes += mf_var[mfi].nBytes();
+  }
+  m_deriveBytes = amrex::max(m_deriveBytes, derive_bytes);
   for (MyParIter pti(*this, level); pti.isValid(); ++pti) {
     const Long Np = pti.numParticles();
     const AoS& pbox = pti.GetArrayOfStructs();
@@ -69,27 +76,29 @@ SprayParticleContainer::computeDerivedVars(
       if (p.id() > 0) {
         RealVect lxc = (p.pos() - plo) * dxi;
         IntVect ijkc = lxc.floor(); // Cell with particle
-        Real T_part = p.rdata(SprayComps::pstateT);
-        Real dia_part = p.rdata(SprayComps::pstateDia);
+        Real T_part = parcelState(p, SprayComps::pstateT);
+        Real dia_part = parcelState(p, SprayComps::pstateDia);
+        Real Y_part[SPRAY_FUEL_NUM];
+        getLiquidY(p, *fdat, Y_part);
         Real rho_part = 0.;
         for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
-          rho_part +=
-            p.rdata(SprayComps::pstateY + spf) / fdat->rhoL(T_part, spf);
+          rho_part += Y_part[spf] / fdat->rhoL(T_part, spf);
         }
         rho_part = 1. / rho_part;
         Real surf = M_PI * dia_part * dia_part;
         Real vol = M_PI / 6. * std::pow(dia_part, 3);
         Real pmass = vol * rho_part;
-        Real num_ppp = p.rdata(SprayComps::pstateNumDens);
+        Real num_ppp = parcelState(p, SprayComps::pstateNumDens);
         Real curvol = cell_vol;
-        Real face_area = AMREX_D_TERM(1., *dx[0], *dx[0]);
+        Real bnd_area = -1.;
 #ifdef AMREX_USE_EB
         if (!flags_array(ijkc).isRegular()) {
           curvol /= volfrac_fab(ijkc);
-          face_area = bar_fab(ijkc);
+          bnd_area = bar_fab(ijkc);
         }
 #endif
-        Real film_hght = p.rdata(SprayComps::pstateFilmHght);
+        Real face_area = filmFaceArea(dx, bnd_area);
+        Real film_hght = parcelState(p, SprayComps::pstateFilmHght);
         if (film_hght == 0.) {
           Gpu::Atomic::Add(&vararr(ijkc, mass_indx), num_ppp * pmass);
           Gpu::Atomic::Add(&vararr(ijkc, dens_indx), num_ppp * pmass / curvol);
@@ -108,19 +117,16 @@ SprayParticleContainer::computeDerivedVars(
           for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
             Gpu::Atomic::Add(
               &vararr(ijkc, vel_indx + dir),
-              num_ppp * pmass * p.rdata(SprayComps::pstateVel + dir));
+              num_ppp * pmass * parcelState(p, SprayComps::pstateVel + dir));
           }
           if (total_spec_indx >= 0) {
             for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
               Gpu::Atomic::Add(
-                &vararr(ijkc, total_spec_indx + spf),
-                p.rdata(SprayComps::pstateY + spf) * pmass);
+                &vararr(ijkc, total_spec_indx + spf), Y_part[spf] * pmass);
             }
           }
         } else {
-          Real rad2 = std::pow(0.5 * dia_part, 2);
-          Real cur_vol =
-            M_PI / 6. * film_hght * (3. * rad2 + film_hght * film_hght);
+          Real cur_vol = filmVolume(dia_part, film_hght);
           Gpu::Atomic::Add(&vararr(ijkc, wfh_indx), cur_vol / face_area);
           Gpu::Atomic::Add(&vararr(ijkc, wfm_indx), rho_part * cur_vol);
         }
@@ -153,3 +159,82 @@ SprayParticleContainer::computeDerivedVars(
 #endif
   }
 }
+
+void
+SprayParticleContainer::tagSprayCells(
+  TagBoxArray& tags,
+  MultiFab& mf_var,
+  const int level,
+  const MultiFab* spray_src,
+  const int src_comp)
+{
+  BL_PROFILE("SprayParticleContainer::tagSprayCells()");
+  const bool tag_parcels = (m_tagNumParcels >= 0.);
+  const bool tag_volf = (m_tagVolFrac >= 0.);
+  const bool tag_evap = (m_tagEvapSrc >= 0. && spray_src != nullptr);
+  if (
+    level >= m_tagMaxLevel ||
+    !(tag_parcels || tag_volf || tag_evap || m_tagClearEmpty)) {
+    return;
+  }
+  // Reuse the accumulation of the derived spray variables, which is done on
+  // the particle grids, then copy the result to the grids of the tags
+  mf_var.setVal(0.);
+  computeDerivedVars(mf_var, level, 0);
+  const int num_vars = NumDeriveVars();
+  MultiFab tag_var(tags.boxArray(), tags.DistributionMap(), num_vars, 0);
+  tag_var.ParallelCopy(mf_var, 0, 0, num_vars);
+  // The spray source normally lives on the gas grids, which are those of the
+  // tags, but is copied if it does not
+  const MultiFab* src_mf = spray_src;
+  int src_indx = src_comp;
+  MultiFab src_copy;
+  if (
+    tag_evap && (spray_src->boxArray() != tags.boxArray() ||
+                 spray_src->DistributionMap() != tags.DistributionMap())) {
+    src_copy.define(tags.boxArray(), tags.DistributionMap(), 1, 0);
+    src_copy.ParallelCopy(*spray_src, src_comp, 0, 1);
+    src_mf = &src_copy;
+    src_indx = 0;
+  }
+  auto derive_indx = [](const std::string& name) {
+    const auto& names = m_sprayDeriveVars;
+    return static_cast<int>(
+      std::find(names.begin(), names.end(), name) - names.begin());
+  };
+  const int mass_indx = derive_indx("spray_mass");
+  const int wfm_indx = derive_indx("wall_film_mass");
+  const int volf_indx = derive_indx("spray_vol_frac");
+  const int nump_indx = derive_indx("num_parcels");
+  const Real max_parcels = m_tagNumParcels;
+  const Real max_volf = m_tagVolFrac;
+  const Real max_evap = m_tagEvapSrc;
+  const bool clear_empty = m_tagClearEmpty;
+  const char tagval = TagBox::SET;
+  const char clearval = TagBox::CLEAR;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+  for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+    const Box bx = mfi.tilebox();
+    auto const& tag_arr = tags.array(mfi);
+    auto const& var_arr = tag_var.const_array(mfi);
+    Array4<const Real> src_arr;
+    if (tag_evap) {
+      src_arr = src_mf->const_array(mfi);
+    }
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      const bool has_spray = var_arr(i, j, k, mass_indx) > 0. ||
+                             var_arr(i, j, k, wfm_indx) > 0.;
+      if (clear_empty && !has_spray) {
+        tag_arr(i, j, k) = clearval;
+      }
+      if (
+        (tag_parcels && var_arr(i, j, k, nump_indx) > max_parcels) ||
+        (tag_volf && var_arr(i, j, k, volf_indx) > max_volf) ||
+        (tag_evap && std::abs(src_arr(i, j, k, src_indx)) > max_evap)) {
+        tag_arr(i, j, k) = tagval;
+      }
+    });
+  }
+}
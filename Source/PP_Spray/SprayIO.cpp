@@ -1,22 +1,110 @@
 
 #include "SprayParticles.H"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 
 using namespace amrex;
 
+namespace {
+// Binary spray initialization files start with this tag, followed by the
+// number of parcels (int64), the number of dimensions, the number of real
+// components per parcel, the size of each real in bytes, and a reserved
+// value (int32 each). Each parcel is then stored as its position followed by
+// its real components
+const char spray_bin_tag[] = "PMSPRAY1";
+const int spray_bin_tag_len = 8;
+const int spray_bin_header_len = spray_bin_tag_len + 8 + 4 * 4;
+// Number of parcels read at a time
+const Long spray_bin_chunk = 1048576;
+
+#ifdef SPRAY_SINGLE_STATE
+// Parcels with the state in ParticleReal, used for the plot, ascii, and
+// ascii initialization files when the state is stored in single precision
+using SprayFullState = ParticleContainer<SprayComps::pstateNum, 0, 0, 0>;
+
+// Copy the parcels of pc into full_pc, which shares its grids
+void
+unpackSprayParcels(SprayParticleContainer& pc, SprayFullState& full_pc)
+{
+  full_pc.reserveData();
+  full_pc.resizeData();
+  for (int lev = 0; lev <= pc.finestLevel(); ++lev) {
+    for (MyParIter pti(pc, lev); pti.isValid(); ++pti) {
+      const Long np = pti.numParticles();
+      auto& dst_tile = full_pc.DefineAndReturnParticleTile(
+        lev, pti.index(), pti.LocalTileIndex());
+      dst_tile.resize(np);
+      const auto* src = pti.GetArrayOfStructs().data();
+      auto* dst = dst_tile.GetArrayOfStructs().data();
+      amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE(Long i) noexcept {
+        auto& pd = dst[i];
+        pd.id() = src[i].id();
+        pd.cpu() = src[i].cpu();
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          pd.pos(dir) = src[i].pos(dir);
+        }
+        for (int comp = 0; comp < SprayComps::pstateNum; ++comp) {
+          pd.rdata(comp) = parcelState(src[i], comp);
+        }
+      });
+    }
+  }
+  Gpu::streamSynchronize();
+}
+
+// Append the parcels of full_pc to pc, rounding the state to single
+// precision
+void
+packSprayParcels(SprayFullState& full_pc, SprayParticleContainer& pc)
+{
+  for (int lev = 0; lev <= full_pc.finestLevel(); ++lev) {
+    for (SprayFullState::ParIterType pti(full_pc, lev); pti.isValid();
+         ++pti) {
+      const Long np = pti.numParticles();
+      auto& dst_tile =
+        pc.DefineAndReturnParticleTile(lev, pti.index(), pti.LocalTileIndex());
+      const auto old_size = dst_tile.GetArrayOfStructs().size();
+      dst_tile.resize(old_size + np);
+      const auto* src = pti.GetArrayOfStructs().data();
+      auto* dst = dst_tile.GetArrayOfStructs().data() + old_size;
+      amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE(Long i) noexcept {
+        auto& pd = dst[i];
+        pd.id() = src[i].id();
+        pd.cpu() = src[i].cpu();
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          pd.pos(dir) = src[i].pos(dir);
+        }
+        for (int slot = 0; slot < NSR_SPR; ++slot) {
+          pd.rdata(slot) = 0.;
+        }
+        for (int comp = 0; comp < SprayComps::pstateNum; ++comp) {
+          parcelState(pd, comp) = static_cast<SprayReal>(src[i].rdata(comp));
+        }
+      });
+    }
+  }
+  Gpu::streamSynchronize();
+}
+#endif
+} // namespace
+
 void
 SprayParticleContainer::SprayParticleIO(
   const int level, const bool is_checkpoint, const std::string& dir)
 {
-  Vector<std::string> real_comp_names(NSR_SPR);
+  Vector<std::string> real_comp_names(SprayComps::pstateNum);
   AMREX_D_TERM(real_comp_names[SprayComps::pstateVel] = "xvel";
                , real_comp_names[SprayComps::pstateVel + 1] = "yvel";
                , real_comp_names[SprayComps::pstateVel + 2] = "zvel";);
   real_comp_names[SprayComps::pstateT] = "temperature";
   real_comp_names[SprayComps::pstateDia] = "diam";
+#ifndef SPRAY_USE_CTM
   for (int sp = 0; sp < SPRAY_FUEL_NUM; ++sp) {
     real_comp_names[SprayComps::pstateY + sp] =
       "spray_mf_" + m_sprayFuelNames[sp];
   }
+#endif
   real_comp_names[SprayComps::pstateNumDens] = "number_density";
   real_comp_names[SprayComps::pstateN0] = "num_dens0";
   if (m_sprayData->do_breakup == 1) {
@@ -30,8 +118,46 @@ SprayParticleContainer::SprayParticleIO(
     real_comp_names[SprayComps::pstateBM2] = "unused2";
   }
   real_comp_names[SprayComps::pstateFilmHght] = "wall_film_height";
+#ifdef SPRAY_USE_CTM
+  real_comp_names[SprayComps::pstateCTM] = "ctm_theta";
+  real_comp_names[SprayComps::pstateCTM + 1] = "ctm_psi";
+#endif
   Vector<std::string> int_comp_names;
+#ifdef SPRAY_SINGLE_STATE
+  // Checkpoints keep the packed state so restarts are exact, while plot and
+  // ascii files get the state unpacked to ParticleReal
+  const bool write_ascii =
+    level == 0 && SprayParticleContainer::write_ascii_files;
+  SprayFullState full_pc(GetParGDB());
+  if (!is_checkpoint || write_ascii) {
+    unpackSprayParcels(*this, full_pc);
+  }
+  if (is_checkpoint) {
+    Vector<std::string> slot_names(NSR_SPR);
+    for (int slot = 0; slot < NSR_SPR; ++slot) {
+      slot_names[slot] = "spray_state_" + std::to_string(slot);
+    }
+    Checkpoint(dir, "particles", true, slot_names, int_comp_names);
+  } else {
+    full_pc.Checkpoint(
+      dir, "particles", false, real_comp_names, int_comp_names);
+  }
+#else
   Checkpoint(dir, "particles", is_checkpoint, real_comp_names, int_comp_names);
+#endif
+  // Keep the inputs used for the run with the checkpoint
+  if (is_checkpoint && level == 0 && ParallelDescriptor::IOProcessor()) {
+    const std::string config_file = dir + "/spray_config";
+    std::ofstream config(config_file.c_str());
+    if (!config.good()) {
+      FileOpenFailed(config_file);
+    }
+    writeSprayConfig(config);
+    config.close();
+    if (!config.good()) {
+      Abort("Problem writing spray config file");
+    }
+  }
   // Here we write ascii information every time we write a plot file
   if (level == 0 && SprayParticleContainer::write_ascii_files) {
     size_t num_end_loc = dir.find_last_of("0123456789") + 1;
@@ -43,7 +169,11 @@ SprayParticleContainer::SprayParticleIO(
     size_t num_end_path = dir_path.find_last_of("/") + 1;
     std::string part_dir_path = dir_path.substr(0, num_end_path);
     std::string fname = part_dir_path + "spray" + numstring + ".p3d";
+#ifdef SPRAY_SINGLE_STATE
+    full_pc.WriteAsciiFile(fname);
+#else
     WriteAsciiFile(fname);
+#endif
   }
   // Since injection can occur over multiple time steps, we must write the
   // current status of each jet in a checkpoint to ensure injection isn't
@@ -97,6 +227,144 @@ SprayParticleContainer::SprayParticleIO(
   }
 }
 
+bool
+SprayParticleContainer::InitFromBinaryFile(const std::string& file)
+{
+  BL_PROFILE("SprayParticleContainer::InitFromBinaryFile()");
+  const Real strt_time = ParallelDescriptor::second();
+  const int level = 0;
+  // The header is read on the I/O rank and broadcast; the first value is
+  // zero if the file is not in the binary format
+  Long header[5] = {0, 0, 0, 0, 0};
+  if (ParallelDescriptor::IOProcessor()) {
+    std::ifstream ifs(file, std::ios::in | std::ios::binary);
+    if (!ifs.good()) {
+      FileOpenFailed(file);
+    }
+    char buf[spray_bin_header_len];
+    ifs.read(buf, spray_bin_header_len);
+    if (
+      ifs.gcount() == spray_bin_header_len &&
+      std::strncmp(buf, spray_bin_tag, spray_bin_tag_len) == 0) {
+      std::int64_t num_parcels = 0;
+      std::int32_t vals[3] = {0, 0, 0};
+      std::memcpy(&num_parcels, buf + spray_bin_tag_len, 8);
+      std::memcpy(vals, buf + spray_bin_tag_len + 8, 3 * 4);
+      header[0] = 1;
+      header[1] = num_parcels;
+      header[2] = vals[0];
+      header[3] = vals[1];
+      header[4] = vals[2];
+    }
+  }
+  ParallelDescriptor::Bcast(header, 5, ParallelDescriptor::IOProcessorNumber());
+  if (header[0] == 0) {
+    return false;
+  }
+  const Long num_parcels = header[1];
+  const int num_vals = static_cast<int>(header[2] + header[3]);
+  const int real_size = static_cast<int>(header[4]);
+  if (header[2] != AMREX_SPACEDIM || header[3] != SprayComps::pstateNum) {
+    Abort(
+      "Spray file " + file + " has " + std::to_string(header[2]) +
+      " dimensions and " + std::to_string(header[3]) +
+      " components, expected " + std::to_string(AMREX_SPACEDIM) + " and " +
+      std::to_string(SprayComps::pstateNum));
+  }
+  if (real_size != 4 && real_size != 8) {
+    Abort("Spray file " + file + " must use 4 or 8 byte reals");
+  }
+  // Only ranks that own grids can hold parcels, so they read the file
+  Vector<int> readers = ParticleDistributionMap(level).ProcessorMap();
+  std::sort(readers.begin(), readers.end());
+  readers.erase(std::unique(readers.begin(), readers.end()), readers.end());
+  const int num_readers = static_cast<int>(readers.size());
+  const int my_proc = ParallelDescriptor::MyProc();
+  const int reader = static_cast<int>(
+    std::find(readers.begin(), readers.end(), my_proc) - readers.begin());
+  Long num_read = 0;
+  if (reader < num_readers) {
+    // Parcels are added to the first local tile and moved by Redistribute
+    MFIter mfi = MakeMFIter(level);
+    auto& dst_tile =
+      GetParticles(level)[std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+    const Long first = num_parcels * reader / num_readers;
+    const Long last = num_parcels * (reader + 1) / num_readers;
+    const Long rec_len = static_cast<Long>(num_vals) * real_size;
+    std::ifstream ifs(file, std::ios::in | std::ios::binary);
+    if (!ifs.good()) {
+      FileOpenFailed(file);
+    }
+    ifs.seekg(spray_bin_header_len + first * rec_len, std::ios::beg);
+    Vector<char> buf;
+    Gpu::HostVector<ParticleType> host_parts;
+    for (Long cur = first; cur < last; cur += spray_bin_chunk) {
+      const Long num_chunk = amrex::min(spray_bin_chunk, last - cur);
+      buf.resize(num_chunk * rec_len);
+      ifs.read(buf.data(), num_chunk * rec_len);
+      if (ifs.gcount() != num_chunk * rec_len) {
+        Abort("Problem reading spray file " + file);
+      }
+      host_parts.resize(num_chunk);
+      for (Long n = 0; n < num_chunk; ++n) {
+        const char* rec = buf.data() + n * rec_len;
+        Real vals[AMREX_SPACEDIM + SprayComps::pstateNum];
+        for (int i = 0; i < num_vals; ++i) {
+          if (real_size == 8) {
+            double val;
+            std::memcpy(&val, rec + i * 8, 8);
+            vals[i] = static_cast<Real>(val);
+          } else {
+            float val;
+            std::memcpy(&val, rec + i * 4, 4);
+            vals[i] = static_cast<Real>(val);
+          }
+        }
+        ParticleType& p = host_parts[n];
+        p.id() = ParticleType::NextID();
+        p.cpu() = my_proc;
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          p.pos(dir) = vals[dir];
+        }
+        for (int slot = 0; slot < NSR_SPR; ++slot) {
+          p.rdata(slot) = 0.;
+        }
+        for (int comp = 0; comp < SprayComps::pstateNum; ++comp) {
+          parcelState(p, comp) = vals[AMREX_SPACEDIM + comp];
+        }
+      }
+      const auto old_size = dst_tile.GetArrayOfStructs().size();
+      dst_tile.resize(old_size + num_chunk);
+      Gpu::copy(
+        Gpu::hostToDevice, host_parts.begin(), host_parts.end(),
+        dst_tile.GetArrayOfStructs().begin() + old_size);
+      num_read += num_chunk;
+    }
+  }
+  Redistribute();
+  if (m_verbose > 0) {
+    ParallelDescriptor::ReduceLongSum(num_read);
+    Real run_time = ParallelDescriptor::second() - strt_time;
+    ParallelDescriptor::ReduceRealMax(run_time);
+    Print() << "Read " << num_read << " parcels from " << file << " on "
+            << num_readers << " ranks in " << run_time << " s" << std::endl;
+  }
+  return true;
+}
+
+void
+SprayParticleContainer::InitFromSprayAsciiFile(const std::string& file)
+{
+#ifdef SPRAY_SINGLE_STATE
+  SprayFullState full_pc(GetParGDB());
+  full_pc.InitFromAsciiFile(file, SprayComps::pstateNum);
+  packSprayParcels(full_pc, *this);
+  Redistribute();
+#else
+  InitFromAsciiFile(file, NSR_SPR);
+#endif
+}
+
 void
 SprayParticleContainer::PostInitRestart(const std::string& dir)
 {
@@ -158,3 +426,334 @@ SprayParticleContainer::PostInitRestart(const std::string& dir)
   }
   Gpu::streamSynchronize();
 }
+
+SprayStats
+SprayParticleContainer::getSprayStats(const int level, const bool local) const
+{
+  SprayStats stats;
+  if (level < m_sprayStats.size()) {
+    stats = m_sprayStats[level];
+  }
+  if (!local) {
+    Long sum_vals[] = {
+      stats.num_active,    stats.num_ghost,   stats.num_virtual,
+      stats.num_src_calls, stats.sum_nsub,    stats.sum_heat_iter,
+      stats.num_breakup,   stats.num_splash,  stats.num_left_domain,
+      stats.num_stored,    stats.num_dead,    stats.num_compacted};
+    Long max_vals[] = {
+      stats.max_subcycles, stats.max_nsub, stats.max_heat_iter};
+    ParallelDescriptor::ReduceLongSum(sum_vals, 12);
+    ParallelDescriptor::ReduceLongMax(max_vals, 3);
+    stats.num_active = sum_vals[0];
+    stats.num_ghost = sum_vals[1];
+    stats.num_virtual = sum_vals[2];
+    stats.num_src_calls = sum_vals[3];
+    stats.sum_nsub = sum_vals[4];
+    stats.sum_heat_iter = sum_vals[5];
+    stats.num_breakup = sum_vals[6];
+    stats.num_splash = sum_vals[7];
+    stats.num_left_domain = sum_vals[8];
+    stats.num_stored = sum_vals[9];
+    stats.num_dead = sum_vals[10];
+    stats.num_compacted = sum_vals[11];
+    stats.max_subcycles = max_vals[0];
+    stats.max_nsub = max_vals[1];
+    stats.max_heat_iter = max_vals[2];
+  }
+  return stats;
+}
+
+void
+SprayParticleContainer::writeSprayStats(const int step, const Real time)
+{
+  BL_PROFILE("SprayParticleContainer::writeSprayStats()");
+  const int num_levs = static_cast<int>(m_sprayStats.size());
+  const bool write_file =
+    !m_statsFile.empty() && ParallelDescriptor::IOProcessor();
+  std::ofstream file;
+  if (write_file) {
+    const bool new_file = !FileSystem::Exists(m_statsFile);
+    file.open(m_statsFile.c_str(), std::ios::out | std::ios::app);
+    if (!file.good()) {
+      FileOpenFailed(m_statsFile);
+    }
+    file.precision(10);
+    if (new_file) {
+      file << "step,time,level,num_active,num_ghost,num_virtual,num_updates,"
+              "max_subcycles,num_src_calls,mean_nsub,max_nsub,sum_heat_iter,"
+              "max_heat_iter,num_breakup,num_splash,num_left_domain,num_stored,"
+              "num_dead,dead_frac,num_compacted\n";
+    }
+  }
+  for (int lev = 0; lev < num_levs; ++lev) {
+    const SprayStats stats = getSprayStats(lev);
+    if (m_verbose > 1) {
+      Print() << "Spray stats on level " << lev << ": " << stats.num_active
+              << " active, " << stats.num_ghost << " ghost, "
+              << stats.num_virtual << " virtual parcels, "
+              << stats.max_subcycles << " max subcycles, "
+              << stats.mean_nsub() << " mean nsub, " << stats.max_nsub
+              << " max nsub, " << stats.sum_heat_iter
+              << " heat transfer iterations, " << stats.num_breakup
+              << " breakup events, " << stats.num_splash
+              << " splash events, " << stats.num_left_domain
+              << " parcels left domain, " << stats.dead_frac()
+              << " removed parcel fraction, " << stats.num_compacted
+              << " parcels compacted" << std::endl;
+    }
+    if (write_file) {
+      file << step << "," << time << "," << lev << "," << stats.num_active
+           << "," << stats.num_ghost << "," << stats.num_virtual << ","
+           << stats.num_updates << "," << stats.max_subcycles << ","
+           << stats.num_src_calls << "," << stats.mean_nsub() << ","
+           << stats.max_nsub << "," << stats.sum_heat_iter << ","
+           << stats.max_heat_iter << "," << stats.num_breakup << ","
+           << stats.num_splash << "," << stats.num_left_domain << ","
+           << stats.num_stored << "," << stats.num_dead << ","
+           << stats.dead_frac() << "," << stats.num_compacted << "\n";
+    }
+    m_sprayStats[lev] = SprayStats();
+  }
+  if (write_file) {
+    file.close();
+    if (!file.good()) {
+      Abort("Problem writing spray stats file");
+    }
+  }
+  // Liquid property tables evaluated outside their temperature range
+  if (m_tabRangeCount != nullptr) {
+    Long num_out = 0;
+    Gpu::dtoh_memcpy(&num_out, m_tabRangeCount, sizeof(Long));
+    const Long zero = 0;
+    Gpu::htod_memcpy(m_tabRangeCount, &zero, sizeof(Long));
+    ParallelDescriptor::ReduceLongSum(num_out);
+    if (m_verbose > 0 && num_out > 0) {
+      Print() << "Liquid property tables evaluated outside their temperature "
+                 "range "
+              << num_out << " times" << std::endl;
+    }
+  }
+  if (m_memReport > 0) {
+    reportSprayMemory();
+  }
+}
+
+void
+SprayParticleContainer::writeSprayConfig(std::ostream& os)
+{
+  const SprayData& fdat = *m_sprayData;
+  SprayUnits SPU;
+#ifdef PELELM_USE_SPRAY
+  const std::string unit_sys = "MKS";
+  const std::string u_cp = "J/(kg K)";
+  const std::string u_eng = "J/kg";
+  const std::string u_rho = "kg/m^3";
+  const std::string u_mu = "kg/(m s)";
+  const std::string u_lambda = "W/(m K)";
+  const std::string u_sigma = "N/m";
+#else
+  const std::string unit_sys = "CGS";
+  const std::string u_cp = "erg/(g K)";
+  const std::string u_eng = "erg/g";
+  const std::string u_rho = "g/cm^3";
+  const std::string u_mu = "g/(cm s)";
+  const std::string u_lambda = "erg/(cm s K)";
+  const std::string u_sigma = "dyn/cm";
+#endif
+  auto put = [&os](
+               const std::string& key, const auto& val,
+               const std::string& unit = "") {
+    os << "particles." << key << " = " << val;
+    if (!unit.empty()) {
+      os << "  # " << unit;
+    }
+    os << '\n';
+  };
+  // Fit coefficients are written as they were given
+  auto put_coef = [&os](
+                    const std::string& key, const Real* coef,
+                    const std::string& unit) {
+    os << "particles." << key << " =";
+    for (int i = 0; i < 4; ++i) {
+      os << " " << coef[i];
+    }
+    os << "  # " << unit << '\n';
+  };
+  const auto old_prec = os.precision(12);
+  os << "# Resolved spray inputs in " << unit_sys << " units\n";
+  put("mass_transfer", fdat.mass_trans);
+  put("mom_transfer", fdat.mom_trans);
+  put("fixed_parts", fdat.fixed_parts);
+  put("cfl", spray_cfl);
+  put("redist_buffer", m_redistBuffer, "cells");
+  put("boil_p_tol", m_boilPresTol);
+  put("sparse_skin", fdat.sparse_skin);
+  put("fuel_ref_temp", fdat.ref_T, "K");
+  os << "particles.fuel_species =";
+  for (const auto& name : m_sprayFuelNames) {
+    os << " " << name;
+  }
+  os << "\nparticles.dep_fuel_species =";
+  for (const auto& name : m_sprayDepNames) {
+    os << " " << name;
+  }
+  os << '\n';
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    const std::string& fuel = m_sprayFuelNames[spf];
+    put(fuel + "_crit_temp", fdat.critT[spf], "K");
+    put(fuel + "_boil_temp", fdat.boilT[spf], "K");
+    put(fuel + "_cp", fdat.cp[spf], u_cp);
+    put(fuel + "_latent", fdat.ref_latent[spf], u_eng);
+    put_coef(fuel + "_rho", &fdat.rho_coef[4 * spf], u_rho + ", cubic in T");
+    put_coef(
+      fuel + "_mu", &fdat.mu_coef[4 * spf], u_mu + ", cubic in 1/T");
+    put_coef(
+      fuel + "_lambda", &fdat.lambda_coef[4 * spf], u_lambda + ", cubic in T");
+    put_coef(fuel + "_psat", &fdat.psat_coef[4 * spf], "Antoine coefficients");
+    const std::string prop_names[LiquidPropTable::num_props] = {
+      "rho", "mu", "lambda", "psat"};
+    for (int n = 0; n < LiquidPropTable::num_props; ++n) {
+      const LiquidPropTable& tab =
+        fdat.prop_tab[LiquidPropTable::num_props * spf + n];
+      if (tab.num_pts > 0) {
+        os << "# " << fuel << " " << prop_names[n] << " is tabulated at "
+           << tab.num_pts << " points from " << tab.T_min << " to "
+           << tab.T_max << " K\n";
+      }
+    }
+  }
+#ifdef SPRAY_USE_CTM
+  const CTMData& ctm = fdat.ctm;
+  put("ctm_gamma", ctm.gamma / SPU.mass_conv, "g/mol");
+  put("ctm_theta", ctm.theta0 / SPU.mass_conv, "g/mol");
+  put(
+    "ctm_sigma",
+    std::sqrt(ctm.psi0 - ctm.theta0 * ctm.theta0) / SPU.mass_conv, "g/mol");
+  put("ctm_tb_a", ctm.tb_a, "K");
+  put("ctm_tb_b", ctm.tb_b * SPU.mass_conv, "K mol/g");
+  put("ctm_vap_entropy", ctm.A);
+  os << "particles.ctm_lump_bounds =";
+  for (int i = 0; i < SPRAY_FUEL_NUM - 1; ++i) {
+    os << " " << ctm.lump_bnd[i] / SPU.mass_conv;
+  }
+  os << "  # g/mol\n";
+#else
+  amrex::ignore_unused(SPU);
+#endif
+  const std::string breakup_names[] = {"None", "TAB", "KHRT"};
+  put("use_breakup_model", breakup_names[fdat.do_breakup]);
+  put("use_splash_model", fdat.do_splash);
+  if (fdat.do_breakup == 1) {
+    put("max_parcel_size", m_maxNumPPP);
+  } else if (fdat.do_breakup == 2) {
+    put("KHRT_B0", m_khrtB0);
+    put("KHRT_B1", m_khrtB1);
+    put("KHRT_C3", m_khrtC3);
+  }
+  if (fdat.do_breakup > 0 || fdat.do_splash) {
+    put("breakup_parcel_factor", m_breakupPPPFact);
+    put("breakup_max_children", m_breakupMaxChildren);
+    put("breakup_max_children_step", m_breakupMaxChildrenStep);
+  }
+  if (fdat.do_splash) {
+    put("wall_temp", fdat.wall_T, "K");
+    put("contact_angle", fdat.theta_c * 180. / M_PI, "degrees");
+    put("film_transport", fdat.film_transport);
+    put("film_cfl", fdat.film_cfl);
+  }
+  if (fdat.sigma > 0.) {
+    put("fuel_sigma", fdat.sigma, u_sigma);
+  }
+  put("use_collision_model", fdat.do_collision);
+  if (fdat.do_collision) {
+    put("collision_seed", m_collisionSeed);
+  }
+  put("merge_int", m_mergeInt);
+  put("aggregate_virtual", m_aggregateVirtual);
+  if (m_mergeInt > 0 || m_aggregateVirtual) {
+    put("merge_dia_tol", m_mergeDiaTol);
+    put("merge_vel_tol", m_mergeVelTol);
+    put("merge_temp_tol", m_mergeTempTol, "K");
+  }
+  put("compact_frac", m_compactFrac);
+  put("parcel_budget", m_maxParcelsPerRank, "parcels per rank");
+  put("defer_injection", m_deferInjection);
+  put("mem_report", m_memReport);
+  put("tag_num_parcels", m_tagNumParcels);
+  put("tag_vol_frac", m_tagVolFrac);
+  put("tag_evap_src", m_tagEvapSrc);
+  put("tag_max_level", m_tagMaxLevel);
+  put("tag_clear_empty", m_tagClearEmpty);
+#ifdef AMREX_USE_EB
+  put("min_eb_vfrac", fdat.min_eb_vfrac);
+#endif
+  put("write_ascii_files", write_ascii_files);
+  put("plot_src", plot_spray_src);
+  put("init_file", spray_init_file);
+  put("stats_file", m_statsFile);
+  put("strict_inputs", m_strictInputs);
+  os.precision(old_prec);
+}
+
+void
+SprayParticleContainer::reportSprayMemory()
+{
+  BL_PROFILE("SprayParticleContainer::reportSprayMemory()");
+  const int num_vals = 5;
+  // Parcels, parcel storage, update scratch, source exchange, and derived
+  // variables on this rank
+  Long vals[num_vals] = {0, 0, m_scratchBytes, 0, m_deriveBytes};
+  for (int lev = 0; lev < this->GetParticles().size(); ++lev) {
+    for (const auto& kv : GetParticles(lev)) {
+      const auto& pvec = kv.second.GetArrayOfStructs()();
+      vals[0] += static_cast<Long>(pvec.size());
+      vals[1] += static_cast<Long>(pvec.capacity()) *
+                 static_cast<Long>(sizeof(ParticleType));
+    }
+  }
+  for (const auto& sx : m_srcExchange) {
+    for (const auto* mf : {sx.sub_src.get(), sx.sub_part.get()}) {
+      if (mf != nullptr) {
+        for (MFIter mfi(*mf); mfi.isValid(); ++mfi) {
+          vals[3] += (*mf)[mfi].nBytes();
+        }
+      }
+    }
+  }
+  const Real to_mb = 1. / 1048576.;
+  if (m_memReport > 1) {
+    AllPrint() << "Spray memory on rank " << ParallelDescriptor::MyProc()
+               << ": " << vals[0] << " parcels, "
+               << static_cast<Real>(vals[1]) * to_mb << " MB parcels, "
+               << static_cast<Real>(vals[2]) * to_mb << " MB update scratch, "
+               << static_cast<Real>(vals[3]) * to_mb
+               << " MB source exchange, "
+               << static_cast<Real>(vals[4]) * to_mb
+               << " MB derived variables" << std::endl;
+  }
+  Long max_vals[num_vals];
+  Long sum_vals[num_vals];
+  for (int n = 0; n < num_vals; ++n) {
+    max_vals[n] = vals[n];
+    sum_vals[n] = vals[n];
+  }
+  ParallelDescriptor::ReduceLongMax(max_vals, num_vals);
+  ParallelDescriptor::ReduceLongSum(sum_vals, num_vals);
+  Print() << "Spray memory, max (total) over ranks: " << max_vals[0] << " ("
+          << sum_vals[0] << ") parcels, "
+          << static_cast<Real>(max_vals[1]) * to_mb << " ("
+          << static_cast<Real>(sum_vals[1]) * to_mb << ") MB parcels, "
+          << static_cast<Real>(max_vals[2]) * to_mb << " ("
+          << static_cast<Real>(sum_vals[2]) * to_mb << ") MB update scratch, "
+          << static_cast<Real>(max_vals[3]) * to_mb << " ("
+          << static_cast<Real>(sum_vals[3]) * to_mb << ") MB source exchange, "
+          << static_cast<Real>(max_vals[4]) * to_mb << " ("
+          << static_cast<Real>(sum_vals[4]) * to_mb
+          << ") MB derived variables" << std::endl;
+  if (m_maxParcelsPerRank >= 0) {
+    Print() << "Spray parcel budget per rank: " << m_maxParcelsPerRank
+            << std::endl;
+  }
+  m_scratchBytes = 0;
+  m_deriveBytes = 0;
+}
@@ -39,6 +39,14 @@ SprayJet::SprayJet(const std::string& jet_name, const amrex::Geometry& geom)
   ps.get("T", m_jetT);
   amrex::Real rho_part = 0.;
   SprayData* fdat = SprayParticleContainer::getSprayData();
+#ifdef SPRAY_USE_CTM
+  // The liquid composition is set by the initial molar mass distribution
+  m_jetY = fdat->ctm.Y0;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    rho_part += m_jetY[spf] / fdat->rhoL(m_jetT, spf);
+  }
+  rho_part = 1. / rho_part;
+#else
   if (SPRAY_FUEL_NUM == 1) {
     m_jetY[0] = 1.;
     rho_part = fdat->rhoL(m_jetT, 0);
@@ -56,7 +64,9 @@ SprayJet::SprayJet(const std::string& jet_name, const amrex::Geometry& geom)
       amrex::Abort(ppspray + ".Y must sum to 1");
     }
   }
+#endif
   ps.query("inject_ppp", m_numPPP);
+  ps.query("max_parcels", m_maxParcelsPerStep);
   // If a rate shape profile is generated at
   // https://www.cmt.upv.es/#/ecn/download/InjectionRateGenerator/InjectionRateGenerator,
   // it can be provided here for use
@@ -135,6 +145,9 @@ SprayJet::SprayJet(
   for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
     m_jetY[spf] = jet_Y[spf];
   }
+#ifdef SPRAY_USE_CTM
+  m_jetY = SprayParticleContainer::getSprayData()->ctm.Y0;
+#endif
   m_dropDist = DistBase::create(dist_type);
   std::string ppspray = "spray";
   m_dropDist->init(ppspray);
@@ -198,11 +211,11 @@ SprayJet::readROI(
   amrex::Real jet_area = 0.25 * M_PI * std::pow(m_jetDia, 2);
   std::string firstline, remaininglines;
 
-  std::ifstream infile(roi_file);
-  const std::string memfile = read_inject_file(infile);
   if (!amrex::FileSystem::Exists(roi_file)) {
-    amrex::Abort("ROI file does not exists");
+    amrex::Abort("ROI file " + roi_file + " does not exist");
   }
+  std::ifstream infile(roi_file);
+  const std::string memfile = read_inject_file(infile);
   infile.close();
   std::istringstream iss(memfile);
 
@@ -215,28 +228,54 @@ SprayJet::readROI(
   amrex::Real mconv = 1.;
 #endif
   m_maxJetVel = 0.;
+  inject_time.clear();
+  inject_mass.clear();
+  inject_vel.clear();
   bool jet_started = false;
+  bool have_prev = false;
   amrex::Real prev_time = 0.;
+  // Line number in the file, the first line is the header
+  int line_num = 1;
   while (std::getline(iss, remaininglines)) {
+    line_num++;
     // Replace any semi-colons with spaces
     std::size_t pos = remaininglines.find(";");
     while (pos != std::string::npos) {
       remaininglines.replace(pos, 1, " ");
       pos = remaininglines.find(";");
     }
+    // Skip empty lines
+    if (remaininglines.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
     std::istringstream sinput(remaininglines);
     amrex::Real time, mdot;
-    sinput >> time;
-    sinput >> mdot;
+    if (!(sinput >> time >> mdot)) {
+      amrex::Abort(
+        "ROI file " + roi_file + ": could not read time and mass flow rate on "
+        "line " + std::to_string(line_num));
+    }
     time *= tconv;
     mdot *= mconv;
+    if (have_prev && time <= prev_time) {
+      amrex::Abort(
+        "ROI file " + roi_file + ": times must be strictly increasing, see "
+        "line " + std::to_string(line_num));
+    }
+    if (mdot < 0.) {
+      amrex::Abort(
+        "ROI file " + roi_file + ": negative mass flow rate on line " +
+        std::to_string(line_num));
+    }
     if (mdot > 0.) {
       if (!jet_started) {
         jet_started = true;
         m_startTime = time;
-        inject_time.push_back(prev_time);
-        inject_mass.push_back(0.);
-        inject_vel.push_back(0.);
+        if (have_prev) {
+          inject_time.push_back(prev_time);
+          inject_mass.push_back(0.);
+          inject_vel.push_back(0.);
+        }
       }
       amrex::Real vel = mdot / (rho_part * jet_area * cd);
       m_maxJetVel = amrex::max(m_maxJetVel, vel);
@@ -252,5 +291,23 @@ SprayJet::readROI(
       break;
     }
     prev_time = time;
+    have_prev = true;
+  }
+  if (!jet_started || inject_time.size() < 2) {
+    amrex::Abort(
+      "ROI file " + roi_file +
+      " must contain at least one positive mass flow rate");
+  }
+  // Check if the times are uniformly spaced so they can be indexed directly
+  const int nvals = static_cast<int>(inject_time.size());
+  const amrex::Real avg_dt = (inject_time[nvals - 1] - inject_time[0]) /
+                             static_cast<amrex::Real>(nvals - 1);
+  m_roiDt = avg_dt;
+  for (int i = 1; i < nvals; ++i) {
+    amrex::Real cur_dt = inject_time[i] - inject_time[i - 1];
+    if (std::abs(cur_dt - avg_dt) > 1.E-6 * avg_dt) {
+      m_roiDt = -1.;
+      break;
+    }
   }
 }
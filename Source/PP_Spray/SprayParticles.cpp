@@ -7,6 +7,9 @@
 #include "TABBreakup.H"
 #include "ReitzKHRT.H"
 #include "WallFilm.H"
+#include "SprayMerge.H"
+#include "SprayCollision.H"
+#include <AMReX_DenseBins.H>
 #ifdef AMREX_USE_EB
 #include <AMReX_EBFArrayBox.H>
 #endif
@@ -81,9 +84,349 @@ SprayParticleContainer::moveKickDrift(
     return;
   }
 
+  if (do_move && !isVirtualPart && !isGhostPart) {
+    if (level >= m_updateStep.size()) {
+      m_updateStep.resize(level + 1, 0);
+    }
+    m_updateStep[level]++;
+    // Periodically merge similar parcels before the update of active parcels
+    if (m_mergeInt > 0 && m_updateStep[level] % m_mergeInt == 0) {
+      mergeParcels(level);
+    }
+    if (m_sprayData->do_collision) {
+      collideParcels(level, dt, m_updateStep[level]);
+    }
+  }
+
   updateParticles(
     level, state, source, dt, time, state_ghosts, source_ghosts, isVirtualPart,
     isGhostPart, do_move, ltransparm, spray_cfl_lev);
+
+  // Compact the tiles where the removed parcels are a large fraction of the
+  // parcels
+  if (do_move && !isVirtualPart && !isGhostPart) {
+    compactParcels(level);
+    // Breakup and splash can exceed the parcel budget without injection
+    if (m_maxParcelsPerRank >= 0) {
+      const Long num_local = TotalNumberOfParticles(true, true);
+      if (num_local > m_maxParcelsPerRank) {
+        Abort(
+          "Spray parcel budget exceeded on rank " +
+          std::to_string(ParallelDescriptor::MyProc()) + " after the update: " +
+          std::to_string(num_local) + " parcels, particles.parcel_budget = " +
+          std::to_string(m_maxParcelsPerRank) +
+          "; consider particles.breakup_max_children or particles.merge_int");
+      }
+    }
+  }
+}
+
+void
+SprayParticleContainer::transferSource(
+  const int& source_ghosts,
+  const int& level,
+  MultiFab& tmpSource,
+  MultiFab& actSource)
+{
+  BL_PROFILE("ParticleContainer::transferSource()");
+  AMREX_ALWAYS_ASSERT(level >= 0);
+  const int nghost = amrex::min(actSource.nGrow(), source_ghosts);
+#ifdef PELELM_USE_SPRAY
+  if (level > 0) {
+    exchangeLevelSource(source_ghosts, level, tmpSource);
+  } else
+#endif
+  {
+    tmpSource.SumBoundary(Geom(level).periodicity());
+  }
+  if (tmpSource.nComp() == actSource.nComp()) {
+    MultiFab::Add(
+      actSource, tmpSource, 0, 0, actSource.nComp(), nghost); // NOLINT
+  } else {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    {
+      for (MFIter mfi(actSource, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        const Box vbox = mfi.growntilebox(nghost);
+        auto const& tmp_array = tmpSource.array(mfi);
+        auto const& act_array = actSource.array(mfi);
+        addSpraySrc(vbox, tmp_array, act_array);
+      }
+    }
+  }
+  tmpSource.setVal(0.);
+}
+
+void
+SprayParticleContainer::exchangeLevelSource(
+  const int source_ghosts, const int level, MultiFab& tmpSource)
+{
+  BL_PROFILE("SprayParticleContainer::exchangeLevelSource()");
+  const int ncomp = tmpSource.nComp();
+  const BoxArray& src_ba = tmpSource.boxArray();
+  const DistributionMapping& src_dm = tmpSource.DistributionMap();
+  const BoxArray& part_ba = this->m_gdb->ParticleBoxArray(level);
+  const DistributionMapping& part_dm =
+    this->m_gdb->ParticleDistributionMap(level);
+  const int nbox = static_cast<int>(src_ba.size());
+  if (level >= m_srcActive.size()) {
+    m_srcActive.resize(level + 1);
+  }
+  Vector<int>& local_active = m_srcActive[level];
+  local_active.resize(nbox, 0);
+  if (level >= m_srcExchange.size()) {
+    m_srcExchange.resize(level + 1);
+  }
+  SourceExchange& sx = m_srcExchange[level];
+  const bool same_grids =
+    sx.sub_src && sx.src_ba == src_ba && sx.src_dm == src_dm &&
+    sx.part_ba == part_ba && sx.part_dm == part_dm &&
+    sx.sub_src->nComp() == ncomp && sx.sub_src->nGrow() == source_ghosts;
+  // The exchanged boxes are reused while they include every box that
+  // received deposits, so only two flags are reduced on most calls
+  int flags[2] = {0, 0};
+  for (int i = 0; i < nbox; ++i) {
+    if (local_active[i] == 1) {
+      flags[0] = 1;
+      if (!same_grids || sx.active[i] == 0) {
+        flags[1] = 1;
+      }
+    }
+  }
+  ParallelDescriptor::ReduceIntMax(flags, 2);
+  // Without deposits there is nothing to exchange
+  if (flags[0] == 0) {
+    return;
+  }
+  if (flags[1] == 1) {
+    Vector<int> active = local_active;
+    ParallelDescriptor::ReduceIntMax(active.data(), nbox);
+    sx.src_ba = src_ba;
+    sx.src_dm = src_dm;
+    sx.part_ba = part_ba;
+    sx.part_dm = part_dm;
+    sx.active = active;
+    sx.src_indx.clear();
+    // Boxes of the source data that received deposits
+    BoxList src_bl;
+    Vector<int> src_procs;
+    for (int i = 0; i < nbox; ++i) {
+      if (active[i] == 1) {
+        src_bl.push_back(src_ba[i]);
+        src_procs.push_back(src_dm[i]);
+        sx.src_indx.push_back(i);
+      }
+    }
+    BoxArray sub_src_ba(src_bl);
+    // Particle boxes that overlap the deposits
+    BoxList part_bl;
+    Vector<int> part_procs;
+    for (int i = 0; i < static_cast<int>(part_ba.size()); ++i) {
+      if (sub_src_ba.intersects(
+            amrex::grow(part_ba[i], source_ghosts), source_ghosts)) {
+        part_bl.push_back(part_ba[i]);
+        part_procs.push_back(part_dm[i]);
+      }
+    }
+    sx.sub_src = std::make_unique<MultiFab>(
+      sub_src_ba, DistributionMapping(src_procs), ncomp, source_ghosts);
+    sx.sub_part = std::make_unique<MultiFab>(
+      BoxArray(part_bl), DistributionMapping(part_procs), ncomp,
+      source_ghosts);
+    // Points sent to other ranks by the add onto the particle boxes and by
+    // the copy back to the source boxes, including periodic images
+    const int my_proc = ParallelDescriptor::MyProc();
+    const std::vector<IntVect> shifts =
+      Geom(level).periodicity().shiftIntVect();
+    auto sent_pts = [&](
+                      const MultiFab& from, const BoxArray& to_ba,
+                      const DistributionMapping& to_dm) -> Long {
+      Long npts = 0;
+      for (int i = 0; i < static_cast<int>(from.size()); ++i) {
+        if (from.DistributionMap()[i] != my_proc) {
+          continue;
+        }
+        const Box gbox = amrex::grow(from.boxArray()[i], source_ghosts);
+        for (const auto& iv : shifts) {
+          for (const auto& isect :
+               to_ba.intersections(gbox + iv, false, source_ghosts)) {
+            if (to_dm[isect.first] != my_proc) {
+              npts += isect.second.numPts();
+            }
+          }
+        }
+      }
+      return npts;
+    };
+    const BoxArray& sub_part_ba = sx.sub_part->boxArray();
+    const DistributionMapping& sub_part_dm = sx.sub_part->DistributionMap();
+    const Long num_pts = sent_pts(*sx.sub_src, sub_part_ba, sub_part_dm) +
+                         sent_pts(*sx.sub_part, src_ba, src_dm);
+    sx.num_bytes = num_pts * ncomp * static_cast<Long>(sizeof(Real));
+  }
+  std::fill(local_active.begin(), local_active.end(), 0);
+  // Gather the deposits locally, no communication is needed since the boxes
+  // have the same owners
+  for (MFIter mfi(*sx.sub_src); mfi.isValid(); ++mfi) {
+    const Box gbox = amrex::grow(mfi.validbox(), source_ghosts);
+    (*sx.sub_src)[mfi].copy<RunOn::Device>(
+      tmpSource[sx.src_indx[mfi.index()]], gbox, 0, gbox, 0, ncomp);
+  }
+  sx.sub_part->setVal(0.);
+  sx.sub_part->ParallelAdd(
+    *sx.sub_src, 0, 0, ncomp, source_ghosts, source_ghosts,
+    Geom(level).periodicity());
+  tmpSource.ParallelCopy(
+    *sx.sub_part, 0, 0, ncomp, source_ghosts, source_ghosts,
+    Geom(level).periodicity());
+  if (m_verbose > 2) {
+    Long num_bytes = sx.num_bytes;
+    ParallelDescriptor::ReduceLongSum(num_bytes);
+    Print() << "Spray source exchange on level " << level << ": "
+            << sx.src_indx.size() << " of " << nbox << " boxes, "
+            << num_bytes << " bytes sent" << std::endl;
+  }
+}
+
+bool
+SprayParticleContainer::needRedistribute(
+  const int lev_min, const int lev_max, Vector<Long>& num_out)
+{
+  BL_PROFILE("SprayParticleContainer::needRedistribute()");
+  // Redistribute to remove invalid parcels once they are this fraction of all
+  // parcels
+  const Real max_invalid_frac = 0.1;
+  const int buffer = amrex::max(0, m_redistBuffer);
+  const int num_levs = static_cast<int>(this->GetParticles().size());
+  num_out.assign(lev_max - lev_min + 1, 0);
+  Long num_invalid = 0;
+  Long num_total = 0;
+  Long num_to_fine = 0;
+  for (int lev = lev_min; lev <= lev_max && lev < num_levs; ++lev) {
+    const auto dxiarr = this->Geom(lev).InvCellSizeArray();
+    const auto ploarr = this->Geom(lev).ProbLoArray();
+    const RealVect dxi(AMREX_D_DECL(dxiarr[0], dxiarr[1], dxiarr[2]));
+    const RealVect plo(AMREX_D_DECL(ploarr[0], ploarr[1], ploarr[2]));
+    const auto phiarr = this->Geom(lev).ProbHiArray();
+    const RealVect phi(AMREX_D_DECL(phiarr[0], phiarr[1], phiarr[2]));
+    const Box domain = this->Geom(lev).Domain();
+    // Parcels in cells covered by a finer level must move to that level
+    const bool has_fine = (lev < finestLevel());
+    BoxArray cfba;
+    if (has_fine) {
+      cfba = amrex::coarsen(
+        this->m_gdb->ParticleBoxArray(lev + 1), this->m_gdb->refRatio(lev));
+    }
+    // Parcels outside the buffer around their tile or outside the domain,
+    // invalid parcels, and parcels in cells covered by the finer level
+    ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+    ReduceData<Long, Long, Long> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    for (MyParIter pti(*this, lev); pti.isValid(); ++pti) {
+      const int Np = pti.numParticles();
+      if (Np == 0) {
+        continue;
+      }
+      num_total += Np;
+      // Parcels outside the domain must be redistributed to be removed or
+      // moved to their periodic image
+      const Box gbox = amrex::grow(pti.tilebox(), buffer) & domain;
+      // Covered regions that parcels of this tile can be in
+      Vector<Box> fine_boxes_h;
+      if (has_fine) {
+        for (const auto& isect : cfba.intersections(gbox)) {
+          fine_boxes_h.push_back(isect.second);
+        }
+      }
+      const int num_fine_boxes = static_cast<int>(fine_boxes_h.size());
+      Gpu::AsyncArray<Box> fine_boxes(fine_boxes_h.data(), num_fine_boxes);
+      const Box* fbox = fine_boxes.data();
+      const ParticleType* pstruct = pti.GetArrayOfStructs()().data();
+      reduce_op.eval(
+        Np, reduce_data, [=] AMREX_GPU_DEVICE(const int i) -> ReduceTuple {
+          const ParticleType& p = pstruct[i];
+          if (p.id() <= 0) {
+            return {0, 1, 0};
+          }
+          const IntVect ijkc = ((p.pos() - plo) * dxi).floor();
+          // Parcels on the upper domain face or past the periodic box can
+          // still be in a domain cell due to round off
+          bool in_box = gbox.contains(ijkc);
+          for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            if (p.pos(dir) < plo[dir] || p.pos(dir) >= phi[dir]) {
+              in_box = false;
+            }
+          }
+          Long to_fine = 0;
+          for (int b = 0; b < num_fine_boxes; ++b) {
+            if (fbox[b].contains(ijkc)) {
+              to_fine = 1;
+              break;
+            }
+          }
+          return {in_box ? 0 : 1, 0, to_fine};
+        });
+    }
+    ReduceTuple hv = reduce_data.value();
+    num_out[lev - lev_min] = amrex::get<0>(hv);
+    num_invalid += amrex::get<1>(hv);
+    num_to_fine += amrex::get<2>(hv);
+  }
+  ParallelDescriptor::ReduceLongSum(
+    num_out.data(), static_cast<int>(num_out.size()));
+  ParallelDescriptor::ReduceLongSum(num_invalid);
+  ParallelDescriptor::ReduceLongSum(num_total);
+  ParallelDescriptor::ReduceLongSum(num_to_fine);
+  Long tot_out = 0;
+  for (const auto& nout : num_out) {
+    tot_out += nout;
+  }
+  return (
+    tot_out > 0 || num_to_fine > 0 ||
+    static_cast<Real>(num_invalid) >
+      max_invalid_frac * static_cast<Real>(num_total));
+}
+
+void
+SprayParticleContainer::SprayRedistribute(
+  int lev_min, int lev_max, int nGrow, int local)
+{
+  BL_PROFILE("SprayParticleContainer::SprayRedistribute()");
+  if (lev_max < 0) {
+    lev_max = finestLevel();
+  }
+  m_redistCalls++;
+  Vector<Long> num_out;
+  bool do_redist = true;
+  if (m_redistBuffer >= 0 || m_verbose > 1) {
+    do_redist = needRedistribute(lev_min, lev_max, num_out);
+  }
+  if (m_redistBuffer < 0) {
+    do_redist = true;
+  }
+  if (!do_redist) {
+    m_redistSkipped++;
+    return;
+  }
+  Real redist_time = ParallelDescriptor::second();
+  Redistribute(lev_min, lev_max, nGrow, local);
+  redist_time = ParallelDescriptor::second() - redist_time;
+  if (m_verbose > 1) {
+    ParallelDescriptor::ReduceRealMax(
+      redist_time, ParallelDescriptor::IOProcessorNumber());
+    for (int lev = lev_min; lev <= lev_max; ++lev) {
+      // Parcels outside their tile are the most that can be sent
+      const Long nout = num_out[lev - lev_min];
+      Print() << "Spray Redistribute on level " << lev << ": " << nout
+              << " parcels moved, at most "
+              << nout * static_cast<Long>(sizeof(ParticleType))
+              << " bytes sent" << std::endl;
+    }
+    Print() << "Spray Redistribute time: " << redist_time << " s, "
+            << m_redistSkipped << " of " << m_redistCalls << " calls skipped"
+            << std::endl;
+  }
 }
 
 Real
@@ -113,10 +456,14 @@ SprayParticleContainer::estTimestep(int level) const
           n, reduce_data, [=] AMREX_GPU_DEVICE(const int i) -> ReduceTuple {
             const ParticleType& p = pstruct[i];
             if (p.id() > 0) {
+              // Wall film is substepped separately, see estFilmTimestep()
+              if (parcelState(p, SprayComps::pstateFilmHght) > 0.) {
+                return 1.E50;
+              }
               const Real max_mag_vdx = amrex::max(AMREX_D_DECL(
-                std::abs(p.rdata(SprayComps::pstateVel)) * dxi[0],
-                std::abs(p.rdata(SprayComps::pstateVel + 1)) * dxi[1],
-                std::abs(p.rdata(SprayComps::pstateVel + 2)) * dxi[2]));
+                std::abs(parcelState(p, SprayComps::pstateVel)) * dxi[0],
+                std::abs(parcelState(p, SprayComps::pstateVel + 1)) * dxi[1],
+                std::abs(parcelState(p, SprayComps::pstateVel + 2)) * dxi[2]));
               Real dt_part = (max_mag_vdx > 0.) ? (cfl / max_mag_vdx) : 1.E50;
               return dt_part;
             }
@@ -136,9 +483,334 @@ SprayParticleContainer::estTimestep(int level) const
     }
   }
   ParallelDescriptor::ReduceRealMin(dt);
+  if (m_verbose > 1 && m_sprayData->film_transport) {
+    Real film_dt = estFilmTimestep(level);
+    if (film_dt > 0. && film_dt < 1.E50) {
+      Print() << "Wall film time step on level " << level << ": " << film_dt
+              << std::endl;
+    }
+  }
+  return dt;
+}
+
+Real
+SprayParticleContainer::estFilmTimestep(int level) const
+{
+  BL_PROFILE("ParticleContainer::estFilmTimestep()");
+  Real dt = std::numeric_limits<Real>::max();
+  if (
+    level >= this->GetParticles().size() || m_sprayData->fixed_parts ||
+    !m_sprayData->film_transport) {
+    return -1.;
+  }
+  const Real cfl = m_sprayData->film_cfl;
+  const auto dxi = Geom(level).InvCellSizeArray();
+  {
+    ReduceOps<ReduceOpMin> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    {
+      for (MyParConstIter pti(*this, level); pti.isValid(); ++pti) {
+        const AoS& pbox = pti.GetArrayOfStructs();
+        const ParticleType* pstruct = pbox().data();
+        const int n = pbox.numParticles();
+        reduce_op.eval(
+          n, reduce_data, [=] AMREX_GPU_DEVICE(const int i) -> ReduceTuple {
+            const ParticleType& p = pstruct[i];
+            if (p.id() > 0 && parcelState(p, SprayComps::pstateFilmHght) > 0.) {
+              const Real max_mag_vdx = amrex::max(AMREX_D_DECL(
+                std::abs(parcelState(p, SprayComps::pstateVel)) * dxi[0],
+                std::abs(parcelState(p, SprayComps::pstateVel + 1)) * dxi[1],
+                std::abs(parcelState(p, SprayComps::pstateVel + 2)) * dxi[2]));
+              Real dt_part = (max_mag_vdx > 0.) ? (cfl / max_mag_vdx) : 1.E50;
+              return dt_part;
+            }
+            return 1.E50;
+          });
+      }
+      ReduceTuple hv = reduce_data.value();
+      Real ldt_cpu = amrex::get<0>(hv);
+      dt = amrex::min(dt, ldt_cpu);
+    }
+  }
+  ParallelDescriptor::ReduceRealMin(dt);
   return dt;
 }
 
+Long
+SprayParticleContainer::mergeParcels(const int level)
+{
+  BL_PROFILE("SprayParticleContainer::mergeParcels()");
+  if (level >= this->GetParticles().size()) {
+    return 0;
+  }
+  Long num_removed = mergeLevelParcels(level);
+  ParallelDescriptor::ReduceLongSum(num_removed);
+  if (m_verbose > 0) {
+    const Real mem_saved = static_cast<Real>(num_removed) *
+                           static_cast<Real>(sizeof(ParticleType)) / 1048576.;
+    Print() << "Merged parcels on level " << level << ": " << num_removed
+            << " parcels removed, " << mem_saved << " MB freed" << std::endl;
+  }
+  return num_removed;
+}
+
+Long
+SprayParticleContainer::mergeLevelParcels(const int level)
+{
+  BL_PROFILE("SprayParticleContainer::mergeLevelParcels()");
+  if (level >= this->GetParticles().size()) {
+    return 0;
+  }
+  const auto dxiarr = this->Geom(level).InvCellSizeArray();
+  const auto ploarr = this->Geom(level).ProbLoArray();
+  const RealVect dxi(AMREX_D_DECL(dxiarr[0], dxiarr[1], dxiarr[2]));
+  const RealVect plo(AMREX_D_DECL(ploarr[0], ploarr[1], ploarr[2]));
+  const SprayData* fdat = d_sprayData;
+  const int do_breakup = m_sprayData->do_breakup;
+  const Real dia_tol = m_mergeDiaTol;
+  const Real vel_tol = m_mergeVelTol;
+  const Real temp_tol = m_mergeTempTol;
+  ReduceOps<ReduceOpSum> reduce_op;
+  ReduceData<Long> reduce_data(reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+  for (MyParIter pti(*this, level); pti.isValid(); ++pti) {
+    auto& pbox = pti.GetArrayOfStructs();
+    ParticleType* pstruct = pbox().data();
+    const int Np = pbox.numParticles();
+    if (Np < 2) {
+      continue;
+    }
+    // Bin the parcels by cell; parcels that have moved outside the tile box
+    // are binned in the nearest cell but are only merged with parcels in
+    // the same cell
+    const Box tbox = pti.tilebox();
+    const IntVect tlo = tbox.smallEnd();
+    const IntVect thi = tbox.bigEnd();
+    DenseBins<ParticleType> bins;
+    bins.build(
+      Np, pstruct, tbox,
+      [=] AMREX_GPU_HOST_DEVICE(const ParticleType& p) noexcept -> IntVect {
+        RealVect lxc = (p.pos() - plo) * dxi;
+        IntVect ijkc = lxc.floor();
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          ijkc[dir] = amrex::max(tlo[dir], amrex::min(thi[dir], ijkc[dir]));
+        }
+        return ijkc;
+      });
+    const auto* offsets = bins.offsetsPtr();
+    const auto* perm = bins.permutationPtr();
+    // Each bin is processed by a single thread, which greedily merges each
+    // parcel with the similar parcels that follow it in the bin
+    reduce_op.eval(
+      static_cast<int>(bins.numBins()), reduce_data,
+      [=] AMREX_GPU_DEVICE(const int bin) -> ReduceTuple {
+        Long num_merged = 0;
+        const auto start = offsets[bin];
+        const auto stop = offsets[bin + 1];
+        for (auto ia = start; ia < stop; ++ia) {
+          ParticleType& pa = pstruct[perm[ia]];
+          if (pa.id() <= 0) {
+            continue;
+          }
+          const IntVect ijka = ((pa.pos() - plo) * dxi).floor();
+          for (auto ib = ia + 1; ib < stop; ++ib) {
+            ParticleType& pb = pstruct[perm[ib]];
+            if (pb.id() <= 0) {
+              continue;
+            }
+            const IntVect ijkb = ((pb.pos() - plo) * dxi).floor();
+            const bool do_merge =
+              (ijka == ijkb) &&
+              canMergeParcels(pa, pb, do_breakup, dia_tol, vel_tol, temp_tol);
+            if (do_merge) {
+              mergeParcelPair(pa, pb, *fdat);
+              num_merged++;
+            }
+          }
+        }
+        return num_merged;
+      });
+  }
+  ReduceTuple hv = reduce_data.value();
+  return amrex::get<0>(hv);
+}
+
+Long
+SprayParticleContainer::compactParcels(const int level)
+{
+  BL_PROFILE("SprayParticleContainer::compactParcels()");
+  if (level >= this->GetParticles().size()) {
+    return 0;
+  }
+  const Real compact_frac = m_compactFrac;
+  if (compact_frac < 0.) {
+    return 0;
+  }
+  if (level >= m_sprayStats.size()) {
+    m_sprayStats.resize(level + 1);
+  }
+  Long num_dead = 0;
+  Long num_removed = 0;
+  Gpu::DeviceVector<int> keep_parts;
+  Gpu::DeviceVector<int> keep_indx;
+  Gpu::DeviceVector<ParticleType> kept;
+  for (MyParIter pti(*this, level); pti.isValid(); ++pti) {
+    auto& pbox = pti.GetArrayOfStructs();
+    ParticleType* pstruct = pbox().data();
+    const int Np = pbox.numParticles();
+    if (Np == 0) {
+      continue;
+    }
+    const int tile_dead = Reduce::Sum<int>(
+      Np, [=] AMREX_GPU_DEVICE(int i) noexcept -> int {
+        return (pstruct[i].id() <= 0) ? 1 : 0;
+      });
+    num_dead += tile_dead;
+    if (
+      tile_dead == 0 ||
+      static_cast<Real>(tile_dead) <= compact_frac * static_cast<Real>(Np)) {
+      continue;
+    }
+    // Gather the valid parcels in their current order and copy them back to
+    // the start of the tile
+    keep_parts.resize(Np);
+    keep_indx.resize(Np);
+    int* keep_d = keep_parts.dataPtr();
+    int* keep_indx_d = keep_indx.dataPtr();
+    amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int i) noexcept {
+      keep_d[i] = (pstruct[i].id() > 0) ? 1 : 0;
+    });
+    const int num_keep = Scan::ExclusiveSum(
+      Np, keep_d, keep_indx_d, Scan::RetSum{true});
+    if (num_keep > 0) {
+      kept.resize(num_keep);
+      ParticleType* kept_d = kept.dataPtr();
+      amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int i) noexcept {
+        if (keep_d[i] == 1) {
+          kept_d[keep_indx_d[i]] = pstruct[i];
+        }
+      });
+      Gpu::copyAsync(
+        Gpu::deviceToDevice, kept.begin(), kept.end(), pbox().begin());
+    }
+    Gpu::streamSynchronize();
+    pti.GetParticleTile().resize(num_keep);
+    num_removed += Np - num_keep;
+  }
+  m_sprayStats[level].num_compacted += num_removed;
+  if (m_verbose > 2) {
+    Long vals[] = {num_dead, num_removed};
+    ParallelDescriptor::ReduceLongSum(vals, 2);
+    Print() << "Compacted parcels on level " << level << ": " << vals[0]
+            << " removed parcels found, " << vals[1] << " parcels compacted"
+            << std::endl;
+  }
+  return num_removed;
+}
+
+void
+SprayParticleContainer::collideParcels(
+  const int level, const Real& dt, const int update_step)
+{
+  BL_PROFILE("SprayParticleContainer::collideParcels()");
+  if (level >= this->GetParticles().size()) {
+    return;
+  }
+  const auto dxiarr = this->Geom(level).InvCellSizeArray();
+  const auto ploarr = this->Geom(level).ProbLoArray();
+  const RealVect dxi(AMREX_D_DECL(dxiarr[0], dxiarr[1], dxiarr[2]));
+  const RealVect plo(AMREX_D_DECL(ploarr[0], ploarr[1], ploarr[2]));
+  const Real inv_vol = AMREX_D_TERM(dxi[0], *dxi[1], *dxi[2]);
+  const SprayData* fdat = d_sprayData;
+  // Random numbers depend only on the seed, update number, and parcel pair
+  const std::uint64_t seed = collisionHash(
+    (static_cast<std::uint64_t>(m_collisionSeed) << 32) ^
+    static_cast<std::uint64_t>(update_step) ^
+    (static_cast<std::uint64_t>(level) << 24));
+  ReduceOps<ReduceOpSum, ReduceOpSum> reduce_op;
+  ReduceData<Long, Long> reduce_data(reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+  for (MyParIter pti(*this, level); pti.isValid(); ++pti) {
+    auto& pbox = pti.GetArrayOfStructs();
+    ParticleType* pstruct = pbox().data();
+    const int Np = pbox.numParticles();
+    if (Np < 2) {
+      continue;
+    }
+    const Box tbox = pti.tilebox();
+    const IntVect tlo = tbox.smallEnd();
+    const IntVect thi = tbox.bigEnd();
+    DenseBins<ParticleType> bins;
+    bins.build(
+      Np, pstruct, tbox,
+      [=] AMREX_GPU_HOST_DEVICE(const ParticleType& p) noexcept -> IntVect {
+        RealVect lxc = (p.pos() - plo) * dxi;
+        IntVect ijkc = lxc.floor();
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          ijkc[dir] = amrex::max(tlo[dir], amrex::min(thi[dir], ijkc[dir]));
+        }
+        return ijkc;
+      });
+    const auto* offsets = bins.offsetsPtr();
+    auto* perm = bins.permutationPtr();
+    reduce_op.eval(
+      static_cast<int>(bins.numBins()), reduce_data,
+      [=] AMREX_GPU_DEVICE(const int bin) -> ReduceTuple {
+        Long num_graze = 0;
+        Long num_coal = 0;
+        const auto start = offsets[bin];
+        const auto stop = offsets[bin + 1];
+        // The order of parcels within a bin depends on the thread layout, so
+        // sort them by key to make the pair order reproducible
+        for (auto ia = start + 1; ia < stop; ++ia) {
+          const auto cur = perm[ia];
+          const std::uint64_t cur_key = collisionKey(pstruct[cur]);
+          auto ib = ia;
+          while (ib > start && collisionKey(pstruct[perm[ib - 1]]) > cur_key) {
+            perm[ib] = perm[ib - 1];
+            --ib;
+          }
+          perm[ib] = cur;
+        }
+        for (auto ia = start; ia < stop; ++ia) {
+          ParticleType& pa = pstruct[perm[ia]];
+          const IntVect ijka = ((pa.pos() - plo) * dxi).floor();
+          for (auto ib = ia + 1; ib < stop && pa.id() > 0; ++ib) {
+            ParticleType& pb = pstruct[perm[ib]];
+            if (pb.id() <= 0) {
+              continue;
+            }
+            const IntVect ijkb = ((pb.pos() - plo) * dxi).floor();
+            if (ijka != ijkb) {
+              continue;
+            }
+            const int coll =
+              collideParcelPair(pa, pb, *fdat, dt, inv_vol, seed);
+            if (coll == 1) {
+              num_graze++;
+            } else if (coll == 2) {
+              num_coal++;
+            }
+          }
+        }
+        return {num_graze, num_coal};
+      });
+  }
+  if (m_verbose > 1) {
+    ReduceTuple hv = reduce_data.value();
+    Long num_graze = amrex::get<0>(hv);
+    Long num_coal = amrex::get<1>(hv);
+    ParallelDescriptor::ReduceLongSum(num_graze);
+    ParallelDescriptor::ReduceLongSum(num_coal);
+    Print() << "Parcel collisions on level " << level << ": " << num_graze
+            << " grazing, " << num_coal << " coalescing" << std::endl;
+  }
+}
+
 void
 SprayParticleContainer::updateParticles(
   const int& level,
@@ -160,25 +832,22 @@ SprayParticleContainer::updateParticles(
   AMREX_ASSERT(OnSameGrids(level, state));
   AMREX_ASSERT(OnSameGrids(level, source));
   bool isActive = !(isVirt || isGhost);
+  // Ghost and virtual parcels are discarded after the update, so only the
+  // parcel state needed for the source terms is evaluated and the breakup
+  // variables are left as they are
+  const bool source_only = !isActive;
   bool do_splash = (m_sprayData->do_splash && isActive && do_move);
   bool do_breakup = (m_sprayData->do_breakup > 0);
   Real B0 = m_khrtB0;
   Real B1 = m_khrtB1;
   Real C3 = m_khrtC3;
   Real max_ppp = m_maxNumPPP;
-  if (m_verbose > 2 && ParallelDescriptor::IOProcessor()) {
-    std::string move_string = "MK";
-    if (do_move) {
-      move_string = "MKD";
-    }
-    std::string part_type = "Active";
-    if (isGhost) {
-      part_type = "Ghost";
-    } else if (isVirt) {
-      part_type = "Virtual";
-    }
-    Print() << move_string << " on " << part_type << " particles on level "
-            << level << std::endl;
+  const Real boil_p_tol = m_boilPresTol;
+  const int redist_buffer = amrex::max(0, m_redistBuffer);
+  // Virtual parcels only deposit sources on the coarser level, so similar
+  // parcels in a cell are aggregated before they are updated
+  if (isVirt && m_aggregateVirtual) {
+    mergeLevelParcels(level);
   }
   const auto dxiarr = this->Geom(level).InvCellSizeArray();
   const auto dxarr = this->Geom(level).CellSizeArray();
@@ -196,6 +865,7 @@ SprayParticleContainer::updateParticles(
   const auto* bndrycent = &(factory.getBndryCent());
   const auto* bndrynorm = &(factory.getBndryNormal());
   const auto* volfrac = &(factory.getVolFrac());
+  const auto* bndryarea = &(factory.getBndryArea());
 #endif
   IntVect bndry_lo; // Designation for boundary types
   IntVect bndry_hi; // 0 - Periodic, 1 - Reflective, -1 - Non-reflective
@@ -239,17 +909,60 @@ SprayParticleContainer::updateParticles(
   }
   // Particle components indices
   SprayComps SPI = m_sprayIndx;
+  const bool track_breakup = (do_breakup && isActive && do_move);
+  if (track_breakup) {
+    m_numBreakupParents = 0;
+    m_numBreakupChildren = 0;
+  }
+  // With a limit on the breakup children per step, the splash and breakup
+  // data of the tiles are kept so the limit is applied in parent order after
+  // all tiles are updated
+  const bool limit_children = (track_breakup && m_breakupMaxChildrenStep > 0);
+  std::map<std::pair<int, int>, SBTileData> sb_tiles;
+  if (level >= m_sprayStats.size()) {
+    m_sprayStats.resize(level + 1);
+  }
+  SprayStats& stats = m_sprayStats[level];
+  // Flag the source boxes the parcels deposit into for exchangeLevelSource
+  if (level >= m_srcActive.size()) {
+    m_srcActive.resize(level + 1);
+  }
+  m_srcActive[level].resize(source.boxArray().size(), 0);
+  for (const auto& kv : GetParticles(level)) {
+    if (kv.second.numParticles() > 0) {
+      m_srcActive[level][kv.first.first] = 1;
+    }
+  }
+  // Parcels updated, calls to calculateSpraySource, sum of substeps, sum of
+  // heat transfer iterations, and parcels that left the domain; followed by
+  // the maximum substeps and heat transfer iterations, and the parcels
+  // flagged for removal at the end of the update
+  ReduceOps<
+    ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum,
+    ReduceOpMax, ReduceOpMax, ReduceOpSum>
+    reduce_op;
+  ReduceData<Long, Long, Long, Long, Long, Long, Long, Long> reduce_data(
+    reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
   // Start the ParIter, which loops over separate sets of particles in different
   // boxes
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
   {
+    Long num_breakup = 0;
+    Long num_splash = 0;
+    Long breakup_parents = 0;
+    Long breakup_children = 0;
+    Long scratch_bytes = 0;
     for (MyParIter pti(*this, level); pti.isValid(); ++pti) {
       const Box tile_box = pti.tilebox();
       const Box src_box = pti.growntilebox(source_ghosts);
       const Box state_box = pti.growntilebox(state_ghosts);
-      bool at_bounds = tile_at_bndry(tile_box, bndry_lo, bndry_hi, domain);
+      // Parcels can be up to particles.redist_buffer cells outside the tile
+      // when a redistribution was skipped
+      const Box part_box = amrex::grow(tile_box, redist_buffer);
+      bool at_bounds = tile_at_bndry(part_box, bndry_lo, bndry_hi, domain);
       const int Np = pti.numParticles();
       if (Np == 0) {
         continue;
@@ -276,6 +989,7 @@ SprayParticleContainer::updateParticles(
       Array4<const Real> bcent_fab;
       Array4<const Real> bnorm_fab;
       Array4<const Real> volfrac_fab;
+      Array4<const Real> barea_fab;
       const auto& flags_array = flags.array();
       if (flags.getType(state_box) == FabType::regular) {
         eb_in_box = false;
@@ -287,6 +1001,8 @@ SprayParticleContainer::updateParticles(
         // Normal of EB
         bnorm_fab = bndrynorm->array(pti);
         volfrac_fab = volfrac->array(pti);
+        // Area of EB
+        barea_fab = bndryarea->array(pti);
       }
 #endif
       bool do_splash_box = (do_splash && (eb_in_box || at_bounds));
@@ -296,19 +1012,25 @@ SprayParticleContainer::updateParticles(
         wf_fab.resize(src_box, 1, The_Async_Arena());
         wf_fab.setVal<RunOn::Device>(0.);
         wf_arr = wf_fab.array();
-        // TODO: Adjust this for EB faces
-        Real face_area = AMREX_D_TERM(dx[0], *dx[1], *dx[2]);
         amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
           ParticleType& p = pstruct[pid];
-          if (p.id() > 0 && p.rdata(SprayComps::pstateFilmHght) > 0.) {
-            fillFilmFab(wf_arr, p, face_area, plo, dx);
+          if (p.id() > 0 && parcelState(p, SprayComps::pstateFilmHght) > 0.) {
+            RealVect lxc = (p.pos() - plo) * dxi;
+            IntVect ijkc = lxc.floor(); // Cell with particle
+            Real bnd_area = -1.;
+#ifdef AMREX_USE_EB
+            if (eb_in_box && flags_array(ijkc).isSingleValued()) {
+              bnd_area = barea_fab(ijkc);
+            }
+#endif
+            fillFilmFab(wf_arr, p, ijkc, filmFaceArea(dx, bnd_area));
           }
         });
       }
       // Data structures for creating new particles during splashing/breakup
       Gpu::HostVector<splash_breakup> N_SB_h;
       Gpu::DeviceVector<splash_breakup> N_SB_d;
-      SBVects refv;
+      auto refv = std::make_unique<SBVects>();
       SBPtrs rf_d;
       bool make_new_drops =
         ((do_breakup || do_splash_box) && isActive && do_move);
@@ -317,169 +1039,240 @@ SprayParticleContainer::updateParticles(
         N_SB_d.resize(Np);
         Gpu::copyAsync(
           Gpu::hostToDevice, N_SB_h.begin(), N_SB_h.end(), N_SB_d.begin());
-        refv.build(Np);
-        refv.fillPtrs_d(rf_d);
+        refv->build(Np);
+        refv->fillPtrs_d(rf_d);
       }
+      scratch_bytes = amrex::max(
+        scratch_bytes,
+        wf_fab.nBytes() + refv->nBytes() +
+          static_cast<Long>(N_SB_h.size() + N_SB_d.size()) *
+            static_cast<Long>(sizeof(splash_breakup)));
       auto N_SB = N_SB_d.dataPtr();
-      amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
-        ParticleType& p = pstruct[pid];
-        if (p.id() > 0) {
-          auto eos = pele::physics::PhysicsType::eos();
-          SprayUnits SPU;
-          GasPhaseVals gpv;
-          GpuArray<Real, SPRAY_FUEL_NUM>
-            cBoilT; // Boiling temperature at current pressure
-          eos.molecular_weight(gpv.mw.data());
-          for (int n = 0; n < NUM_SPECIES; ++n) {
-            gpv.mw[n] *= SPU.mass_conv;
-          }
-          GpuArray<IntVect, AMREX_D_PICK(2, 4, 8)>
-            indx_array; // array of adjacent cells
-          GpuArray<Real, AMREX_D_PICK(2, 4, 8)>
-            weights; // array of corresponding weights
-          RealVect lx = (p.pos() - plo) * dxi + 0.5;
-          IntVect ijk = lx.floor(); // Upper cell center
-          RealVect lxc = (p.pos() - plo) * dxi;
-          IntVect ijkc = lxc.floor(); // Cell with particle
-          IntVect bflags(IntVect::TheZeroVector());
-          if (at_bounds) {
-            // Check if particle has left the domain or is boundary adjacent
-            bool left_dom =
-              check_bounds(p.pos(), plo, phi, dx, bndry_lo, bndry_hi, bflags);
-            if (left_dom) {
-              Abort("Particle has incorrectly left the domain");
+      reduce_op.eval(
+        Np, reduce_data,
+        [=] AMREX_GPU_DEVICE(int pid) noexcept -> ReduceTuple {
+          ParticleType& p = pstruct[pid];
+          Long num_parcels = 0;
+          Long num_src = 0;
+          Long sum_nsub = 0;
+          Long sum_heat_iter = 0;
+          Long num_left = 0;
+          Long max_nsub = 0;
+          Long max_heat_iter = 0;
+          if (p.id() > 0) {
+            num_parcels = 1;
+            auto eos = pele::physics::PhysicsType::eos();
+            SprayUnits SPU;
+            GasPhaseVals gpv;
+            GpuArray<Real, SPRAY_FUEL_NUM>
+              cBoilT; // Boiling temperature at current pressure
+            eos.molecular_weight(gpv.mw.data());
+            for (int n = 0; n < NUM_SPECIES; ++n) {
+              gpv.mw[n] *= SPU.mass_conv;
             }
-          }
-          // Used for ETAB breakup model
-          Real Utan_total = 0.;
-          Real Reyn_d = 0.;
-          // Subcycle loop
-          for (int cur_iter = 0; cur_iter < num_iter && p.id() > 0;
-               ++cur_iter) {
-            bool is_film = false;
-            // Gather wall film values
-            if (p.rdata(SprayComps::pstateFilmHght) > 0.) {
-              is_film = true;
+            GpuArray<IntVect, AMREX_D_PICK(2, 4, 8)>
+              indx_array; // array of adjacent cells
+            GpuArray<Real, AMREX_D_PICK(2, 4, 8)>
+              weights; // array of corresponding weights
+            RealVect lx = (p.pos() - plo) * dxi + 0.5;
+            IntVect ijk = lx.floor(); // Upper cell center
+            RealVect lxc = (p.pos() - plo) * dxi;
+            IntVect ijkc = lxc.floor(); // Cell with particle
+            // Ghost parcels outside the source box cannot contribute sources
+            if (isGhost && !src_box.contains(ijkc)) {
+              p.id() = -1;
+              return {num_parcels, num_src, sum_nsub, sum_heat_iter, num_left,
+                      max_nsub, max_heat_iter, 1};
             }
-            // Flag for whether we are near EB boundaries
-            bool do_fe_interp = false;
+            IntVect bflags(IntVect::TheZeroVector());
+            if (at_bounds) {
+              // Check if particle has left the domain or is boundary adjacent
+              bool left_dom =
+                check_bounds(p.pos(), plo, phi, dx, bndry_lo, bndry_hi, bflags);
+              if (left_dom) {
+                Abort("Particle has incorrectly left the domain");
+              }
+            }
+            // Used for ETAB breakup model
+            Real Utan_total = 0.;
+            Real Reyn_d = 0.;
+            // Gas pressure used for the current boiling temperatures
+            Real p_boil = -1.;
+            // Subcycle loop
+            for (int cur_iter = 0; cur_iter < num_iter && p.id() > 0;
+                 ++cur_iter) {
+              bool is_film = false;
+              // Gather wall film values
+              if (parcelState(p, SprayComps::pstateFilmHght) > 0.) {
+                is_film = true;
+              }
+              // Flag for whether we are near EB boundaries
+              bool do_fe_interp = false;
 #ifdef AMREX_USE_EB
-            if (eb_in_box) {
-              do_fe_interp = eb_interp(
-                p, ijkc, ijk, dx, dxi, lx, plo, bflags, flags_array, ccent_fab,
-                bcent_fab, bnorm_fab, volfrac_fab, fdat->min_eb_vfrac,
+              if (eb_in_box) {
+                do_fe_interp = eb_interp(
+                  p, ijkc, ijk, dx, dxi, lx, plo, bflags, flags_array,
+                  ccent_fab, bcent_fab, bnorm_fab, volfrac_fab,
+                  fdat->min_eb_vfrac, indx_array.data(), weights.data());
+              } else
+#endif
+              {
+                trilinear_interp(
+                  ijk, lx, indx_array.data(), weights.data(), bflags);
+              }
+              // Interpolate fluid state
+              gpv.reset();
+              InterpolateGasPhase(
+                gpv, state_box, rhoarr, rhoYarr, Tarr, momarr, engarr,
                 indx_array.data(), weights.data());
-            } else
+              // Solve for avg mw and pressure at droplet location
+              gpv.define();
+              // Boiling temperatures only depend on the gas pressure, so they
+              // are reused while the pressure is within boil_p_tol
+              if (std::abs(gpv.p_fluid - p_boil) > boil_p_tol * p_boil) {
+                fdat->calcBoilT(gpv, cBoilT.data());
+                p_boil = gpv.p_fluid;
+              }
+              if (is_film) {
+                RealVect wall_norm = RealVect::TheZeroVector();
+                if (fdat->film_transport) {
+                  bool on_wall = false;
+                  wall_norm = filmWallNormal(
+                    bflags, bndry_lo, bndry_hi, ijkc,
+#ifdef AMREX_USE_EB
+                    eb_in_box, flags_array, bnorm_fab,
 #endif
-            {
-              trilinear_interp(
-                ijk, lx, indx_array.data(), weights.data(), bflags);
-            }
-            // Interpolate fluid state
-            gpv.reset();
-            InterpolateGasPhase(
-              gpv, state_box, rhoarr, rhoYarr, Tarr, momarr, engarr,
-              indx_array.data(), weights.data());
-            // Solve for avg mw and pressure at droplet location
-            gpv.define();
-            fdat->calcBoilT(gpv, cBoilT.data());
-            if (is_film) {
-              calculateFilmSource(
-                sub_dt, gpv, *fdat, p, cBoilT.data(), ltransparm);
-            } else {
-              Reyn_d = calculateSpraySource(
-                sub_dt, gpv, *fdat, p, cBoilT.data(), ltransparm);
-            }
-            IntVect cur_indx = ijkc;
-            Real cvol = inv_vol;
-            if (p.id() > 0 && do_breakup) {
-              // Update breakup variables and determine if breakup occurs
-              if (fdat->do_breakup == 1) {
-                Utan_total += updateBreakupTAB(
-                  Reyn_d, sub_dt, cBoilT.data(), gpv, *fdat, p);
+                    on_wall);
+                }
+                calculateFilmSource(
+                  sub_dt, gpv, *fdat, p, cBoilT.data(), wall_norm,
+                  filmWallDist(wall_norm, dx), ltransparm);
+              } else {
+                SourceCounters src_count;
+                Reyn_d = calculateSpraySource(
+                  sub_dt, gpv, *fdat, p, cBoilT.data(), ltransparm,
+                  &src_count);
+                num_src++;
+                sum_nsub += src_count.nsub;
+                sum_heat_iter += src_count.heat_iter;
+                max_nsub = amrex::max(max_nsub, Long(src_count.nsub));
+                max_heat_iter =
+                  amrex::max(max_heat_iter, Long(src_count.heat_iter));
               }
-              if (cur_iter == num_iter - 1) {
-                if (fdat->do_breakup == 1 && make_new_drops) {
-                  // Determine if parcel must be split into multiple parcels
-                  splitDropletTAB(pid, p, max_ppp, N_SB, rf_d, Utan_total);
-                } else {
-                  // Update breakup for KH-RT model
-                  updateBreakupKHRT(
-                    pid, p, Reyn_d, fdat->dtmod * flow_dt, cBoilT.data(),
-                    avg_inject_mass, B0, B1, C3, gpv, *fdat, N_SB, rf_d,
-                    make_new_drops);
+              IntVect cur_indx = ijkc;
+              Real cvol = inv_vol;
+              if (p.id() > 0 && do_breakup && !source_only) {
+                // Update breakup variables and determine if breakup occurs
+                if (fdat->do_breakup == 1) {
+                  Utan_total += updateBreakupTAB(
+                    Reyn_d, sub_dt, cBoilT.data(), gpv, *fdat, p);
+                }
+                if (cur_iter == num_iter - 1) {
+                  if (fdat->do_breakup == 1 && make_new_drops) {
+                    // Determine if parcel must be split into multiple parcels
+                    splitDropletTAB(pid, p, max_ppp, N_SB, rf_d, Utan_total);
+                  } else {
+                    // Update breakup for KH-RT model
+                    updateBreakupKHRT(
+                      pid, p, Reyn_d, fdat->dtmod * flow_dt, cBoilT.data(),
+                      avg_inject_mass, B0, B1, C3, gpv, *fdat, N_SB, rf_d,
+                      make_new_drops);
+                  }
                 }
               }
-            }
 #ifdef AMREX_USE_EB
-            if (flags_array(cur_indx).isSingleValued()) {
-              cvol *= 1. / (volfrac_fab(cur_indx));
-            }
+              if (flags_array(cur_indx).isSingleValued()) {
+                cvol *= 1. / (volfrac_fab(cur_indx));
+              }
 #endif
-            Real cur_coef = -cvol * sub_dt / flow_dt;
-            if (!src_box.contains(cur_indx)) {
-              if (!isGhost) {
-                Abort("SprayParticleContainer::updateParticles() -- source box "
-                      "too small");
+              Real cur_coef = -cvol * sub_dt / flow_dt;
+              if (!src_box.contains(cur_indx)) {
+                if (!isGhost) {
+                  Abort("SprayParticleContainer::updateParticles() -- source "
+                        "box too small");
+                }
               }
-            }
-            if (fdat->mom_trans) {
-              for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
-                Gpu::Atomic::Add(
-                  &momSrcarr(cur_indx, dir), cur_coef * gpv.fluid_mom_src[dir]);
+              if (fdat->mom_trans) {
+                for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                  Gpu::Atomic::Add(
+                    &momSrcarr(cur_indx, dir),
+                    cur_coef * gpv.fluid_mom_src[dir]);
+                }
               }
-            }
-            if (fdat->mass_trans) {
-              Gpu::Atomic::Add(
-                &rhoSrcarr(cur_indx), cur_coef * gpv.fluid_mass_src);
-              for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+              if (fdat->mass_trans) {
                 Gpu::Atomic::Add(
-                  &rhoYSrcarr(cur_indx, spf), cur_coef * gpv.fluid_Y_dot[spf]);
-              }
-            }
-            Gpu::Atomic::Add(
-              &engSrcarr(cur_indx), cur_coef * gpv.fluid_eng_src);
-            Real new_time = static_cast<Real>(cur_iter + 1) * sub_dt;
-            // Modify particle position by whole time step
-            if (do_move && !fdat->fixed_parts && p.id() > 0 && !is_film) {
-              for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
-                const Real cvel = p.rdata(SprayComps::pstateVel + dir);
-                p.pos(dir) += sub_dt * cvel;
+                  &rhoSrcarr(cur_indx), cur_coef * gpv.fluid_mass_src);
+                for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+                  Gpu::Atomic::Add(
+                    &rhoYSrcarr(cur_indx, spf),
+                    cur_coef * gpv.fluid_Y_dot[spf]);
+                }
               }
-              if (at_bounds || do_fe_interp) {
-                // First check if particle has exited the domain through a
-                // Cartesian boundary
-                bool left_dom = check_bounds(
-                  p.pos(), plo, phi, dx, bndry_lo, bndry_hi, bflags);
-                if (left_dom) {
-                  p.id() = -1;
-                } else {
-                  Real film_h = 0.;
-                  if (do_splash_box) {
-                    film_h = wf_arr(ijkc, 0);
+              Gpu::Atomic::Add(
+                &engSrcarr(cur_indx), cur_coef * gpv.fluid_eng_src);
+              Real new_time = static_cast<Real>(cur_iter + 1) * sub_dt;
+              // Modify particle position by whole time step
+              if (do_move && !fdat->fixed_parts && p.id() > 0 && !is_film) {
+                for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                  const Real cvel = parcelState(p, SprayComps::pstateVel + dir);
+                  p.pos(dir) += sub_dt * cvel;
+                }
+                if (at_bounds || do_fe_interp) {
+                  // First check if particle has exited the domain through a
+                  // Cartesian boundary
+                  bool left_dom = check_bounds(
+                    p.pos(), plo, phi, dx, bndry_lo, bndry_hi, bflags);
+                  if (left_dom) {
+                    p.id() = -1;
+                    num_left++;
+                  } else {
+                    Real film_h = 0.;
+                    if (do_splash_box) {
+                      film_h = wf_arr(ijkc, 0);
+                    }
+                    // Next reflect particles off BC or EB walls if necessary
+                    impose_wall(
+                      do_splash_box, pid, p, *fdat, dx, plo, phi, bflags,
+                      cBoilT.data(), gpv.p_fluid, eb_in_box,
+#ifdef AMREX_USE_EB
+                      flags_array, bcent_fab, bnorm_fab,
+#endif
+                      ijkc, N_SB, rf_d, film_h);
                   }
-                  // Next reflect particles off BC or EB walls if necessary
-                  impose_wall(
-                    do_splash_box, pid, p, *fdat, dx, plo, phi, bflags,
-                    cBoilT.data(), gpv.p_fluid, eb_in_box,
+                } // if (at_bounds || fe_interp)
+                // Update indices
+                lx = (p.pos() - plo) * dxi + 0.5;
+                ijk = lx.floor();
+                lxc = (p.pos() - plo) * dxi;
+                ijkc = lxc.floor(); // New cell center
+              } else if (
+                do_move && !fdat->fixed_parts && p.id() > 0 && is_film &&
+                fdat->film_transport) {
+                // Wall film is moved along the wall with its own substeps
+                bool left_dom = moveFilm(
+                  p, sub_dt, fdat->film_cfl, dx, plo, phi, bndry_lo, bndry_hi,
 #ifdef AMREX_USE_EB
-                    flags_array, bcent_fab, bnorm_fab,
+                  eb_in_box, flags_array, bcent_fab, bnorm_fab,
 #endif
-                    ijkc, N_SB, rf_d, film_h);
+                  bflags);
+                if (left_dom) {
+                  p.id() = -1;
+                  num_left++;
                 }
-              } // if (at_bounds || fe_interp)
-              // Update indices
-              lx = (p.pos() - plo) * dxi + 0.5;
-              ijk = lx.floor();
-              lxc = (p.pos() - plo) * dxi;
-              ijkc = lxc.floor(); // New cell center
-            }
-            if (isGhost && !src_box.contains(ijkc)) {
-              p.id() = -1;
-            }
-          } // End of subcycle loop
-        }   // End of p.id() > 0 check
-      });   // End of loop over particles
+                lx = (p.pos() - plo) * dxi + 0.5;
+                ijk = lx.floor();
+                lxc = (p.pos() - plo) * dxi;
+                ijkc = lxc.floor();
+              }
+              if (isGhost && !src_box.contains(ijkc)) {
+                p.id() = -1;
+              }
+            } // End of subcycle loop
+          }   // End of p.id() > 0 check
+          const Long num_dead = (p.id() <= 0) ? 1 : 0;
+          return {num_parcels, num_src, sum_nsub, sum_heat_iter, num_left,
+                  max_nsub, max_heat_iter, num_dead};
+        }); // End of loop over particles
       if (make_new_drops) {
         Gpu::copy(
           Gpu::deviceToHost, N_SB_d.begin(), N_SB_d.end(), N_SB_h.begin());
@@ -487,16 +1280,103 @@ SprayParticleContainer::updateParticles(
         for (int n = 0; n < Np; n++) {
           if (N_SB_h[n] != splash_breakup::no_change) {
             get_new_parts = true;
+            if (N_SB_h[n] < splash_breakup::splash_dry_splash) {
+              num_breakup++;
+            } else {
+              num_splash++;
+            }
           }
         }
         if (get_new_parts) {
-          refv.retrieve_data();
-          SBPtrs rfh;
-          refv.fillPtrs_h(rfh);
-          CreateSBDroplets(Np, sub_dt, N_SB_h.data(), rfh, level);
+          refv->retrieve_data();
+          if (limit_children) {
+            SBTileData sbt;
+            sbt.N_SB_h = std::move(N_SB_h);
+            sbt.refv = std::move(refv);
+#ifdef AMREX_USE_OMP
+#pragma omp critical(spray_breakup_tiles)
+#endif
+            sb_tiles[std::make_pair(pti.index(), pti.LocalTileIndex())] =
+              std::move(sbt);
+          } else {
+            SBPtrs rfh;
+            refv->fillPtrs_h(rfh);
+            std::vector<int> num_children(Np);
+            breakup_parents +=
+              breakupChildCounts(Np, N_SB_h.data(), rfh, num_children.data());
+            for (const int nc : num_children) {
+              breakup_children += nc;
+            }
+            CreateSBDroplets(
+              Np, sub_dt, N_SB_h.data(), rfh, num_children.data(), level);
+          }
         }
       }
       Gpu::streamSynchronize();
     } // for (int MyParIter pti..
+#ifdef AMREX_USE_OMP
+#pragma omp critical(spray_stats)
+#endif
+    {
+      stats.num_breakup += num_breakup;
+      stats.num_splash += num_splash;
+      m_numBreakupParents += breakup_parents;
+      m_numBreakupChildren += breakup_children;
+      m_scratchBytes = amrex::max(m_scratchBytes, scratch_bytes);
+    }
+  }
+  if (!sb_tiles.empty()) {
+    createLimitedSBDroplets(sb_tiles, sub_dt, level);
+  }
+  ReduceTuple hv = reduce_data.value();
+  if (isGhost) {
+    stats.num_ghost = amrex::get<0>(hv);
+  } else if (isVirt) {
+    stats.num_virtual = amrex::get<0>(hv);
+  } else {
+    stats.num_active = amrex::get<0>(hv);
+    if (do_move) {
+      // Counted before compaction, including the new breakup and splash
+      // parcels; the stored count only sums the tile sizes on this rank
+      stats.num_stored = NumberOfParticlesAtLevel(level, false, true);
+      stats.num_dead = amrex::get<7>(hv);
+    }
+  }
+  stats.num_updates++;
+  stats.max_subcycles = amrex::max(stats.max_subcycles, Long(num_iter));
+  stats.num_src_calls += amrex::get<1>(hv);
+  stats.sum_nsub += amrex::get<2>(hv);
+  stats.sum_heat_iter += amrex::get<3>(hv);
+  stats.num_left_domain += amrex::get<4>(hv);
+  stats.max_nsub = amrex::max(stats.max_nsub, amrex::get<5>(hv));
+  stats.max_heat_iter = amrex::max(stats.max_heat_iter, amrex::get<6>(hv));
+  if (m_verbose > 2) {
+    // Parcels counted by the update kernel, so the count is only reduced
+    // across ranks when it is printed
+    Long num_parts = amrex::get<0>(hv);
+    ParallelDescriptor::ReduceLongSum(num_parts);
+    std::string move_string = "MK";
+    if (do_move) {
+      move_string = "MKD";
+    }
+    std::string part_type = "Active";
+    if (isGhost) {
+      part_type = "Ghost";
+    } else if (isVirt) {
+      part_type = "Virtual";
+    }
+    Print() << move_string << " on " << num_parts << " " << part_type
+            << " particles on level " << level << std::endl;
+  }
+  if (track_breakup && m_verbose > 1) {
+    Long num_parents = m_numBreakupParents;
+    Long num_children = m_numBreakupChildren;
+    ParallelDescriptor::ReduceLongSum(num_parents);
+    ParallelDescriptor::ReduceLongSum(num_children);
+    if (num_parents > 0) {
+      Print() << "Breakup on level " << level << ": " << num_parents
+              << " parent parcels, " << num_children << " child parcels"
+              << std::endl;
+    }
   }
 }
@@ -3,15 +3,118 @@
 #include "SBData.H"
 #include "AhamedSplash.H"
 #include "Distributions.H"
+#include "SprayRandom.H"
+#include <cstring>
 
 using namespace amrex;
 
+namespace {
+// Reproducible random number based on the state of the parent parcel
+Real
+parentRandom(const RealVect& loc, const Real dia, const std::uint64_t stream)
+{
+  // Zeroed so the upper bytes are defined when Real is float
+  std::uint64_t key[AMREX_SPACEDIM + 1] = {0};
+  for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+    std::memcpy(&key[dir], &loc[dir], sizeof(Real));
+  }
+  std::memcpy(&key[AMREX_SPACEDIM], &dia, sizeof(Real));
+  std::uint64_t seed = key[0];
+  for (int i = 1; i < AMREX_SPACEDIM; ++i) {
+    seed = collisionHash(seed ^ key[i]);
+  }
+  return collisionRandom(seed, key[AMREX_SPACEDIM], 0, stream);
+}
+} // namespace
+
+Long
+SprayParticleContainer::breakupChildCounts(
+  const int Np,
+  const splash_breakup* N_SB_h,
+  const SBPtrs& rfh,
+  int* num_children)
+{
+  Long num_parents = 0;
+  for (int n = 0; n < Np; n++) {
+    num_children[n] = 0;
+    if (
+      N_SB_h[n] != splash_breakup::no_change &&
+      N_SB_h[n] < splash_breakup::splash_dry_splash) {
+      Real num_dens0 = rfh.num_dens[n];
+      Real N_s = std::pow(num_dens0, m_breakupPPPFact);
+      int N_d = amrex::max(1, static_cast<int>(num_dens0 / N_s));
+      if (m_breakupMaxChildren > 0) {
+        N_d = amrex::min(N_d, m_breakupMaxChildren);
+      }
+      num_children[n] = N_d;
+      num_parents++;
+    }
+  }
+  return num_parents;
+}
+
+void
+SprayParticleContainer::createLimitedSBDroplets(
+  std::map<std::pair<int, int>, SBTileData>& sb_tiles,
+  const Real sub_dt,
+  const int level)
+{
+  // Child counts of all tiles, in tile and parent index order
+  std::map<std::pair<int, int>, std::vector<int>> tile_children;
+  Long num_parents = 0;
+  Long num_wanted = 0;
+  for (auto& sbt : sb_tiles) {
+    const int Np = static_cast<int>(sbt.second.N_SB_h.size());
+    SBPtrs rfh;
+    sbt.second.refv->fillPtrs_h(rfh);
+    std::vector<int>& num_children = tile_children[sbt.first];
+    num_children.resize(Np);
+    num_parents += breakupChildCounts(
+      Np, sbt.second.N_SB_h.data(), rfh, num_children.data());
+    for (const int nc : num_children) {
+      num_wanted += nc;
+    }
+  }
+  // Each parent makes at least one child parcel so mass is conserved. The
+  // remaining children are shared in proportion to the extra children each
+  // parent wants, using the floor of the scaled exclusive scan so the counts
+  // sum exactly to the limit
+  const Long num_avail = amrex::min(
+    num_wanted,
+    amrex::max(num_parents, static_cast<Long>(m_breakupMaxChildrenStep)));
+  if (num_avail < num_wanted) {
+    const Long num_extra = num_avail - num_parents;
+    const Long wanted_extra = num_wanted - num_parents;
+    Long scan = 0;
+    for (auto& tc : tile_children) {
+      for (int& nc : tc.second) {
+        if (nc > 0) {
+          const Long lo = (num_extra * scan) / wanted_extra;
+          scan += nc - 1;
+          const Long hi = (num_extra * scan) / wanted_extra;
+          nc = 1 + static_cast<int>(hi - lo);
+        }
+      }
+    }
+  }
+  m_numBreakupParents += num_parents;
+  m_numBreakupChildren += num_avail;
+  for (auto& sbt : sb_tiles) {
+    SBPtrs rfh;
+    sbt.second.refv->fillPtrs_h(rfh);
+    CreateSBDroplets(
+      static_cast<int>(sbt.second.N_SB_h.size()), sub_dt,
+      sbt.second.N_SB_h.data(), rfh, tile_children[sbt.first].data(), level);
+  }
+}
+
 void
 SprayParticleContainer::CreateSBDroplets(
   const int Np,
   const Real sub_dt,
   const splash_breakup* N_SB_h,
   const SBPtrs& rfh,
+  const int* num_children,
   const int level)
 {
   ParticleLocData pld;
@@ -51,9 +154,15 @@ SprayParticleContainer::CreateSBDroplets(
 #if SPRAY_FUEL_NUM > 1
       Real rho_part = 0.;
       Real mu_part = 0.;
+#ifdef SPRAY_USE_CTM
+      fdat->ctm.massFrac(rfh.ctm0[2 * n], rfh.ctm0[2 * n + 1], Y0.data());
+#else
       const int vy = SPRAY_FUEL_NUM * n;
       for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
         Y0[spf] = rfh.Y0[vy + spf];
+      }
+#endif
+      for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
         rho_part += Y0[spf] / fdat->rhoL(T0, spf);
         mu_part += Y0[spf] * fdat->muL(T0, spf);
       }
@@ -96,7 +205,7 @@ SprayParticleContainer::CreateSBDroplets(
           p.cpu() = ParallelDescriptor::MyProc();
           Real new_mass = ms_thetas[new_parts];
           Real dia_part = std::cbrt(6. * new_mass / (M_PI * rho_part));
-          p.rdata(SprayComps::pstateDia) = dia_part;
+          parcelState(p, SprayComps::pstateDia) = dia_part;
           Real utBeta = uBeta_half;
           if (new_parts == 1) {
             utBeta = uBeta_0;
@@ -109,34 +218,58 @@ SprayParticleContainer::CreateSBDroplets(
               usNorm * normal[dir], +utBeta * tanBeta[dir],
               +utPsi * tanPsi[dir]);
             p.pos(dir) = loc0[dir] + dia_part * normal[dir];
-            p.rdata(SprayComps::pstateVel + dir) = pvel;
+            parcelState(p, SprayComps::pstateVel + dir) = pvel;
           }
+#ifdef SPRAY_USE_CTM
+          parcelState(p, SprayComps::pstateCTM) = rfh.ctm0[2 * n];
+          parcelState(p, SprayComps::pstateCTM + 1) = rfh.ctm0[2 * n + 1];
+#else
           for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
-            p.rdata(SprayComps::pstateY + spf) = Y0[spf];
+            parcelState(p, SprayComps::pstateY + spf) = Y0[spf];
           }
-          p.rdata(SprayComps::pstateBM1) = 0.;
-          p.rdata(SprayComps::pstateBM2) = 0.;
-          p.rdata(SprayComps::pstateFilmHght) = 0.;
-          p.rdata(SprayComps::pstateN0) = num_dens0;
-          p.rdata(SprayComps::pstateNumDens) = num_dens0;
+#endif
+          parcelState(p, SprayComps::pstateBM1) = 0.;
+          parcelState(p, SprayComps::pstateBM2) = 0.;
+          parcelState(p, SprayComps::pstateFilmHght) = 0.;
+          parcelState(p, SprayComps::pstateN0) = num_dens0;
+          parcelState(p, SprayComps::pstateNumDens) = num_dens0;
           bool where = Where(p, pld);
           if (!where) {
             amrex::Abort("Bad reflected particle");
           }
-          p.rdata(SprayComps::pstateT) = T0;
+          parcelState(p, SprayComps::pstateT) = T0;
           host_particles[ind].push_back(p);
         }
         // Breakup
       } else {
         Real Utan = phi1;
         Real dmean = ref_dia;
-        // num_dens0 = N_s N_d, where N_d - number of newly created parcels and
-        // N_s - number density of newly created parcels There is no one way to
-        // do this
-        Real N_s = std::pow(num_dens0, m_breakupPPPFact);
-        int N_d = amrex::max(1, static_cast<int>(num_dens0 / N_s));
-        N_s = num_dens0 / static_cast<Real>(N_d);
-        Real new_mass = M_PI / 6. * rho_part * std::pow(dmean, 3);
+        const int N_d = num_children[n];
+        // KH child diameters are sampled at evenly spaced probabilities of the
+        // chi-squared distribution with an SMD equal to the reference
+        // diameter, so the sampling is reproducible
+        std::vector<Real> child_dia(N_d, dmean);
+        if (m_sprayData->do_breakup == 2 && N_d > 1) {
+          const ChiSquared kh_dist(dmean);
+          SprayUnits SPU;
+          const Real min_dia =
+            8. * std::cbrt(SPU.min_mass * 3. / (4. * M_PI * rho_part));
+          for (int new_parts = 0; new_parts < N_d; ++new_parts) {
+            const Real prob = (static_cast<Real>(new_parts) + 0.5) /
+                              static_cast<Real>(N_d);
+            child_dia[new_parts] =
+              amrex::max(min_dia, kh_dist.quantile(prob));
+          }
+        }
+        // All child parcels have the same number density, which is set so
+        // the child mass num_dens0 * pmass is conserved
+        Real child_vol = 0.;
+        for (const auto& cdia : child_dia) {
+          child_vol += std::pow(cdia, 3);
+        }
+        const Real N_s = num_dens0 * std::pow(dmean, 3) / child_vol;
+        // Offset for the azimuthal angle of the child velocities
+        const Real psi_offset = parentRandom(loc0, ref_dia, 0);
 #if AMREX_SPACEDIM == 3
         RealVect testvec(1., 0., 0.);
         if (testvec.crossProduct(normal).vectorLength() < 1.E-5) {
@@ -150,26 +283,32 @@ SprayParticleContainer::CreateSBDroplets(
         RealVect tanBeta(normal[1], normal[0]);
 #endif
         for (int new_parts = 0; new_parts < N_d; ++new_parts) {
-          Real rand = amrex::Random();
+          const Real rand = (static_cast<Real>(new_parts) + psi_offset) /
+                            static_cast<Real>(N_d);
           ParticleType p;
           p.id() = ParticleType::NextID();
           p.cpu() = ParallelDescriptor::MyProc();
-          p.rdata(SprayComps::pstateDia) = dmean;
-          p.rdata(SprayComps::pstateT) = T0;
+          parcelState(p, SprayComps::pstateDia) = child_dia[new_parts];
+          parcelState(p, SprayComps::pstateT) = T0;
+#ifdef SPRAY_USE_CTM
+          parcelState(p, SprayComps::pstateCTM) = rfh.ctm0[2 * n];
+          parcelState(p, SprayComps::pstateCTM + 1) = rfh.ctm0[2 * n + 1];
+#else
           for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
-            p.rdata(SprayComps::pstateY + spf) = Y0[spf];
+            parcelState(p, SprayComps::pstateY + spf) = Y0[spf];
           }
+#endif
           if (m_sprayData->do_breakup == 2) {
-            p.rdata(SprayComps::pstateBM1) = 0.;
-            p.rdata(SprayComps::pstateBM2) = 0.;
+            parcelState(p, SprayComps::pstateBM1) = 0.;
+            parcelState(p, SprayComps::pstateBM2) = 0.;
           } else {
-            p.rdata(SprayComps::pstateBM1) = phi2;
-            p.rdata(SprayComps::pstateBM2) = phi3;
+            parcelState(p, SprayComps::pstateBM1) = phi2;
+            parcelState(p, SprayComps::pstateBM2) = phi3;
           }
 
-          p.rdata(SprayComps::pstateFilmHght) = 0.;
-          p.rdata(SprayComps::pstateN0) = N_s;
-          p.rdata(SprayComps::pstateNumDens) = N_s;
+          parcelState(p, SprayComps::pstateFilmHght) = 0.;
+          parcelState(p, SprayComps::pstateN0) = N_s;
+          parcelState(p, SprayComps::pstateNumDens) = N_s;
           for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
 #if AMREX_SPACEDIM == 3
             Real psi = rand * 2. * M_PI;
@@ -180,7 +319,7 @@ SprayParticleContainer::CreateSBDroplets(
             Real pvel = vel0[dir] + sgn * Utan * tanBeta[dir];
 #endif
             p.pos(dir) = loc0[dir] + sub_dt * pvel;
-            p.rdata(SprayComps::pstateVel + dir) = pvel;
+            parcelState(p, SprayComps::pstateVel + dir) = pvel;
           }
           bool where = Where(p, pld);
           if (!where) {
@@ -1,5 +1,7 @@
 
 #include "SprayParticles.H"
+#include <algorithm>
+#include <sstream>
 
 using namespace amrex;
 
@@ -8,16 +10,41 @@ std::string SprayParticleContainer::m_sprayDepNames[SPRAY_FUEL_NUM];
 Vector<std::string> SprayParticleContainer::m_sprayDeriveVars;
 SprayData* SprayParticleContainer::m_sprayData = nullptr;
 SprayData* SprayParticleContainer::d_sprayData = nullptr;
+Long* SprayParticleContainer::m_tabRangeCount = nullptr;
 SprayComps SprayParticleContainer::m_sprayIndx;
 Real SprayParticleContainer::spray_cfl = 0.5;
 bool SprayParticleContainer::write_ascii_files = false;
 bool SprayParticleContainer::plot_spray_src = false;
 Real SprayParticleContainer::m_maxNumPPP = 100.;
 Real SprayParticleContainer::m_breakupPPPFact = 0.5;
+int SprayParticleContainer::m_breakupMaxChildren = -1;
+Long SprayParticleContainer::m_breakupMaxChildrenStep = -1;
 Real SprayParticleContainer::m_khrtB0 = 0.61;
 Real SprayParticleContainer::m_khrtB1 = 7.;
 Real SprayParticleContainer::m_khrtC3 = 1.;
+int SprayParticleContainer::m_mergeInt = 0;
+Real SprayParticleContainer::m_mergeDiaTol = 0.1;
+Real SprayParticleContainer::m_mergeVelTol = 0.1;
+Real SprayParticleContainer::m_mergeTempTol = 5.;
+Real SprayParticleContainer::m_compactFrac = -1.;
+Long SprayParticleContainer::m_maxParcelsPerRank = -1;
+bool SprayParticleContainer::m_deferInjection = false;
+int SprayParticleContainer::m_memReport = 0;
+bool SprayParticleContainer::m_strictInputs = false;
+Vector<std::string> SprayParticleContainer::m_ignoreInputs;
+int SprayParticleContainer::m_collisionSeed = 0;
+bool SprayParticleContainer::m_aggregateVirtual = false;
+int SprayParticleContainer::m_redistBuffer = -1;
+Real SprayParticleContainer::m_tagNumParcels = -1.;
+Real SprayParticleContainer::m_tagVolFrac = -1.;
+Real SprayParticleContainer::m_tagEvapSrc = -1.;
+int SprayParticleContainer::m_tagMaxLevel = 100;
+Real SprayParticleContainer::m_boilPresTol = 0.;
+bool SprayParticleContainer::m_tagClearEmpty = false;
 std::string SprayParticleContainer::spray_init_file;
+std::string SprayParticleContainer::m_statsFile;
+Vector<SprayStats> SprayParticleContainer::m_sprayStats;
+Vector<Vector<int>> SprayParticleContainer::m_srcActive;
 
 void
 getInpCoef(
@@ -70,6 +97,95 @@ getInpVal(
   }
 }
 
+// Read a table of liquid properties written by propcoeff.py. The first
+// line names the columns, T followed by any of rho, mu, lambda, and psat,
+// and each following line has the values at a temperature; temperatures
+// must be increasing and uniformly spaced
+void
+readPropTable(const std::string& file, LiquidPropTable* tabs)
+{
+  Vector<char> file_chars;
+  ParallelDescriptor::ReadAndBcastFile(file, file_chars);
+  std::istringstream is(std::string(file_chars.dataPtr()));
+  std::string line;
+  std::vector<std::string> cols;
+  while (cols.empty() && std::getline(is, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream ls(line);
+    std::string col;
+    while (ls >> col) {
+      cols.push_back(col);
+    }
+  }
+  const std::string prop_names[LiquidPropTable::num_props] = {
+    "rho", "mu", "lambda", "psat"};
+  const int ncols = static_cast<int>(cols.size());
+  std::vector<int> col_prop(ncols, -1);
+  if (ncols < 2 || cols[0] != "T") {
+    Abort("Liquid property table " + file + " must start with a T column");
+  }
+  for (int c = 1; c < ncols; ++c) {
+    for (int n = 0; n < LiquidPropTable::num_props; ++n) {
+      if (cols[c] == prop_names[n]) {
+        col_prop[c] = n;
+      }
+    }
+    if (col_prop[c] < 0) {
+      Abort("Unknown column " + cols[c] + " in " + file);
+    }
+  }
+  std::vector<std::vector<Real>> data(ncols);
+  while (std::getline(is, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::istringstream ls(line);
+    for (int c = 0; c < ncols; ++c) {
+      Real val;
+      if (!(ls >> val)) {
+        Abort("Missing values in liquid property table " + file);
+      }
+      data[c].push_back(val);
+    }
+  }
+  const int npts = static_cast<int>(data[0].size());
+  if (npts < 2 || npts > LiquidPropTable::max_pts) {
+    Abort(
+      "Liquid property table " + file + " must have between 2 and " +
+      std::to_string(LiquidPropTable::max_pts) + " temperatures");
+  }
+  const Real T_min = data[0][0];
+  const Real T_max = data[0][npts - 1];
+  const Real dT = (T_max - T_min) / static_cast<Real>(npts - 1);
+  for (int k = 1; k < npts; ++k) {
+    if (dT <= 0. || std::abs(data[0][k] - data[0][k - 1] - dT) > 1.E-6 * dT) {
+      Abort(
+        "Temperatures in liquid property table " + file +
+        " must be increasing and uniformly spaced");
+    }
+  }
+  for (int c = 1; c < ncols; ++c) {
+    LiquidPropTable& tab = tabs[col_prop[c]];
+    tab.num_pts = npts;
+    tab.T_min = T_min;
+    tab.T_max = T_max;
+    tab.dTi = 1. / dT;
+    tab.log_vals =
+      (col_prop[c] == LiquidPropTable::mu ||
+       col_prop[c] == LiquidPropTable::psat);
+    for (int k = 0; k < npts; ++k) {
+      const Real val = data[c][k];
+      if (val <= 0.) {
+        Abort(cols[c] + " in liquid property table " + file + " must be > 0");
+      }
+      tab.val[k] = tab.log_vals ? std::log(val) : val;
+    }
+    tab.setSlopes();
+  }
+}
+
 void
 SprayParticleContainer::readSprayParams(int& particle_verbose)
 {
@@ -92,6 +208,25 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
   if (spray_cfl > max_cfl) {
     Abort("particles.cfl must be <= " + std::to_string(max_cfl));
   }
+  pp.query("redist_buffer", m_redistBuffer);
+  //
+  // Relative change in the gas pressure before the boiling temperatures of
+  // a parcel are recomputed during the spray subcycles
+  //
+  pp.query("boil_p_tol", m_boilPresTol);
+  //
+  // Only evaluate the skin phase transport properties, which scale with the
+  // square of the number of gas species, on the first spray substep
+  //
+  pp.query("sparse_skin", m_sprayData->sparse_skin);
+  //
+  // Spray refinement criteria
+  //
+  pp.query("tag_num_parcels", m_tagNumParcels);
+  pp.query("tag_vol_frac", m_tagVolFrac);
+  pp.query("tag_evap_src", m_tagEvapSrc);
+  pp.query("tag_max_level", m_tagMaxLevel);
+  pp.query("tag_clear_empty", m_tagClearEmpty);
   // Number of fuel species in spray droplets
   // Must match the number specified at compile time
   const int nfuel = pp.countval("fuel_species");
@@ -116,8 +251,31 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
     getInpCoef(
       m_sprayData->lambda_coef.data(), pp, fuel_names.data(), "lambda");
     getInpCoef(m_sprayData->psat_coef.data(), pp, fuel_names.data(), "psat");
-    getInpCoef(
-      m_sprayData->rho_coef.data(), pp, fuel_names.data(), "rho", true);
+    // Tabulated properties replace the fits
+    bool use_tables = false;
+    for (int i = 0; i < nfuel; ++i) {
+      std::string tab_file;
+      if (pp.query((fuel_names[i] + "_prop_table").c_str(), tab_file)) {
+        readPropTable(
+          tab_file,
+          &m_sprayData->prop_tab[LiquidPropTable::num_props * i]);
+        use_tables = true;
+      }
+      const int rho_indx =
+        LiquidPropTable::num_props * i + LiquidPropTable::rho;
+      const std::string rho_read = fuel_names[i] + "_rho";
+      if (
+        m_sprayData->prop_tab[rho_indx].num_pts == 0 &&
+        !pp.contains(rho_read.c_str())) {
+        Abort("particles." + rho_read + " must be set or tabulated");
+      }
+    }
+    if (use_tables) {
+      m_tabRangeCount = static_cast<Long*>(The_Arena()->alloc(sizeof(Long)));
+      const Long zero = 0;
+      Gpu::htod_memcpy(m_tabRangeCount, &zero, sizeof(Long));
+    }
+    getInpCoef(m_sprayData->rho_coef.data(), pp, fuel_names.data(), "rho");
     getInpCoef(m_sprayData->mu_coef.data(), pp, fuel_names.data(), "mu");
     for (int i = 0; i < nfuel; ++i) {
       m_sprayFuelNames[i] = fuel_names[i];
@@ -129,6 +287,51 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
       m_sprayData->latent[i] = m_sprayData->ref_latent[i];
     }
   }
+#ifdef SPRAY_USE_CTM
+  //
+  // Continuous thermodynamics model, the fuel species are the gas lumps;
+  // molar masses are given in g/mol
+  //
+  {
+    SprayUnits SPU;
+    CTMData& ctm = m_sprayData->ctm;
+    Real ctm_sigma = 0.;
+    pp.get("ctm_gamma", ctm.gamma);
+    pp.get("ctm_theta", ctm.theta0);
+    pp.get("ctm_sigma", ctm_sigma);
+    pp.get("ctm_tb_a", ctm.tb_a);
+    pp.get("ctm_tb_b", ctm.tb_b);
+    pp.query("ctm_vap_entropy", ctm.A);
+    if (ctm.theta0 <= ctm.gamma || ctm_sigma <= 0.) {
+      Abort("'ctm_theta' must be greater than 'ctm_gamma' and 'ctm_sigma' "
+            "must be positive");
+    }
+    if (pp.countval("ctm_lump_bounds") != SPRAY_FUEL_NUM - 1) {
+      Abort("'ctm_lump_bounds' must have SPRAY_FUEL_NUM - 1 values");
+    }
+    // A single lump takes all of the vapor and needs no bounds
+    std::vector<Real> lump_bnd(SPRAY_FUEL_NUM - 1, 0.);
+#if SPRAY_FUEL_NUM > 1
+    pp.getarr("ctm_lump_bounds", lump_bnd);
+#endif
+    Real prev_bnd = ctm.gamma;
+    for (int i = 0; i < SPRAY_FUEL_NUM - 1; ++i) {
+      if (lump_bnd[i] <= prev_bnd) {
+        Abort("'ctm_lump_bounds' must increase and be greater than "
+              "'ctm_gamma'");
+      }
+      prev_bnd = lump_bnd[i];
+      ctm.lump_bnd[i] = lump_bnd[i] * SPU.mass_conv;
+    }
+    ctm.gamma *= SPU.mass_conv;
+    ctm.theta0 *= SPU.mass_conv;
+    ctm.tb_b /= SPU.mass_conv;
+    ctm_sigma *= SPU.mass_conv;
+    ctm.psi0 = ctm.theta0 * ctm.theta0 + ctm_sigma * ctm_sigma;
+    ctm.limitMoments(ctm.theta0, ctm.psi0);
+    ctm.massFrac(ctm.theta0, ctm.psi0, ctm.Y0.data());
+  }
+#endif
 
   Real spray_ref_T = 300.;
   bool splash_model = false;
@@ -158,10 +361,15 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
     if (m_breakupPPPFact > 1. || m_breakupPPPFact < 0.) {
       Abort("'breakup_parcel_factor' must be between 0 and 1");
     }
+    pp.query("breakup_max_children", m_breakupMaxChildren);
+    pp.query("breakup_max_children_step", m_breakupMaxChildrenStep);
     bool wrong_data = false;
     for (int i = 0; i < nfuel; ++i) {
       std::string var_read = fuel_names[i] + "_mu";
-      if (!pp.contains(var_read.c_str())) {
+      const int mu_indx = LiquidPropTable::num_props * i + LiquidPropTable::mu;
+      if (
+        !pp.contains(var_read.c_str()) &&
+        m_sprayData->prop_tab[mu_indx].num_pts == 0) {
         wrong_data = true;
       }
     }
@@ -178,12 +386,57 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
         Abort("'contact_angle' must be between 0 and 180");
       }
       m_sprayData->theta_c = theta_c_deg * M_PI / 180.;
+      // Move the wall film along the wall due to the gas phase shear
+      pp.query("film_transport", m_sprayData->film_transport);
+      pp.query("film_cfl", m_sprayData->film_cfl);
+      if (m_sprayData->film_cfl <= 0. || m_sprayData->film_cfl > 1.) {
+        Abort("'film_cfl' must be between 0 and 1");
+      }
     }
     // Set the fuel surface tension and contact angle
     pp.get("fuel_sigma", m_sprayData->sigma);
     m_sprayData->do_splash = splash_model;
     m_sprayData->do_breakup = breakup_model;
   }
+  //
+  // Set if droplet collisions and coalescence are modeled
+  //
+  pp.query("use_collision_model", m_sprayData->do_collision);
+  if (m_sprayData->do_collision) {
+    pp.query("collision_seed", m_collisionSeed);
+    if (!pp.contains("fuel_sigma")) {
+      Abort("fuel_sigma must be set for the collision model");
+    }
+    pp.get("fuel_sigma", m_sprayData->sigma);
+  }
+  //
+  // Set if similar parcels in a cell should be merged and how often
+  //
+  pp.query("merge_int", m_mergeInt);
+  pp.query("aggregate_virtual", m_aggregateVirtual);
+  if (m_mergeInt > 0 || m_aggregateVirtual) {
+    pp.query("merge_dia_tol", m_mergeDiaTol);
+    pp.query("merge_vel_tol", m_mergeVelTol);
+    pp.query("merge_temp_tol", m_mergeTempTol);
+    if (m_mergeDiaTol < 0. || m_mergeVelTol < 0. || m_mergeTempTol < 0.) {
+      Abort("Parcel merging tolerances must be non-negative");
+    }
+  }
+  //
+  // Set when tiles are compacted to remove parcels flagged for removal
+  //
+  pp.query("compact_frac", m_compactFrac);
+  if (m_compactFrac >= 1.) {
+    Abort("particles.compact_frac must be less than 1");
+  }
+  //
+  // Set the parcel budget on each rank and the memory report verbosity
+  //
+  pp.query("parcel_budget", m_maxParcelsPerRank);
+  if (m_maxParcelsPerRank >= 0) {
+    pp.query("defer_injection", m_deferInjection);
+  }
+  pp.query("mem_report", m_memReport);
 
   // Must use same reference temperature for all fuels
   pp.get("fuel_ref_temp", spray_ref_T);
@@ -199,6 +452,10 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
   // Used in initData() on startup to read in a file of particles.
   //
   pp.query("init_file", spray_init_file);
+  //
+  // CSV file the spray counters are written to by writeSprayStats()
+  //
+  pp.query("stats_file", m_statsFile);
 #ifdef AMREX_USE_EB
   //
   // Spray source terms are only added to cells with a volume fraction higher
@@ -238,6 +495,32 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
       m_sprayDeriveVars.push_back("spray_mass_" + fuel_name);
     }
   }
+  //
+  // Check that the inputs are consistent with each other
+  //
+  if (spray_cfl <= 0.) {
+    Abort("particles.cfl must be positive");
+  }
+  // Parcels can move cfl cells in a step but the state and source ghost
+  // cells only reserve std::round(cfl) cells for this
+  const Real cfl_cells = amrex::max(1., std::round(spray_cfl));
+  if (spray_cfl > cfl_cells) {
+    Abort(
+      "particles.cfl = " + std::to_string(spray_cfl) +
+      " lets parcels move farther than the " +
+      std::to_string(static_cast<int>(cfl_cells)) +
+      " ghost cells reserved for them; use a value of at most " +
+      std::to_string(static_cast<int>(cfl_cells)) + " or round it up");
+  }
+  if ((splash_model || breakup_model > 0) && !m_sprayData->mom_trans) {
+    Abort("Splash and breakup models require particles.mom_transfer = 1");
+  }
+  //
+  // Inputs that were never read are checked in checkSprayInputs once the
+  // host and the problem setup have read theirs
+  //
+  pp.query("strict_inputs", m_strictInputs);
+  pp.queryarr("ignore_inputs", m_ignoreInputs);
 
   if (particle_verbose >= 1 && ParallelDescriptor::IOProcessor()) {
     Print() << "Spray fuel species " << m_sprayFuelNames[0];
@@ -247,6 +530,26 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
     }
 #endif
     Print() << std::endl;
+#ifdef SPRAY_USE_CTM
+    Print() << "Initial lump mass fractions";
+    for (int i = 0; i < SPRAY_FUEL_NUM; ++i) {
+      Print() << " " << m_sprayData->ctm.Y0[i];
+    }
+    Print() << std::endl;
+#endif
+    // Positions are stored in ParticleReal and the parcel state in
+    // SprayReal, which is float with SPRAY_SINGLE_STATE
+    const auto prec = [](const size_t size) -> std::string {
+      return (size == sizeof(float)) ? "single" : "double";
+    };
+    Print() << "Spray parcels store positions in "
+            << prec(sizeof(ParticleReal)) << " precision and "
+            << SprayComps::pstateNum << " state components in "
+            << prec(sizeof(SprayReal)) << " precision, "
+            << sizeof(ParticleType) << " bytes per parcel" << std::endl;
+  }
+  if (particle_verbose > 1 && ParallelDescriptor::IOProcessor()) {
+    writeSprayConfig(OutStream());
   }
   Gpu::streamSynchronize();
   ParallelDescriptor::Barrier();
@@ -288,10 +591,20 @@ SprayParticleContainer::spraySetup(const Real* body_force)
     const int fspec = m_sprayData->indx[ns];
     m_sprayData->latent[ns] -= fuelEnth[fspec] * SPU.eng_conv;
   }
+  Vector<Real> spec_mw(NUM_SPECIES);
+  eos.molecular_weight(spec_mw.data());
+  for (int ns = 0; ns < NUM_SPECIES; ++ns) {
+    spec_mw[ns] *= SPU.mass_conv;
+  }
+  m_sprayData->setBoilTFact(spec_mw.data());
   for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
     m_sprayData->body_force[dir] = body_force[dir];
   }
-  Gpu::copy(Gpu::hostToDevice, m_sprayData, m_sprayData + 1, d_sprayData);
+  // The counter of out of range table evaluations is in device memory, so
+  // only the device copy counts them
+  SprayData dev_data = *m_sprayData;
+  dev_data.tab_range_count = m_tabRangeCount;
+  Gpu::copy(Gpu::hostToDevice, &dev_data, &dev_data + 1, d_sprayData);
   Gpu::streamSynchronize();
   ParallelDescriptor::Barrier();
 }
@@ -318,9 +631,46 @@ SprayParticleContainer::SprayInitialize(
 #endif
   );
   if (!spray_init_file.empty()) {
-    InitFromAsciiFile(spray_init_file, NSR_SPR);
+    if (!InitFromBinaryFile(spray_init_file)) {
+      InitFromSprayAsciiFile(spray_init_file);
+    }
   } else if (!restart_dir.empty()) {
     Restart(restart_dir, "particles");
   }
   PostInitRestart(restart_dir);
+  checkSprayInputs();
+}
+
+void
+SprayParticleContainer::checkSprayInputs()
+{
+  // Inputs that were never read are misspelled or not used with the selected
+  // models. Keys read by AMReX for every particle container are skipped,
+  // since some are only read when particles are written, and keys read
+  // elsewhere can be listed in particles.ignore_inputs
+  const Vector<std::string> amrex_inputs = {
+    "do_tiling",   "tile_size", "do_mem_efficient_sort",
+    "use_prepost", "do_unlink", "particles_nfiles",
+    "datadigits_read"};
+  std::string unused_inputs;
+  for (const auto& entry : ParmParse::getUnusedInputs("particles.")) {
+    const std::string name = entry.substr(0, entry.find(' '));
+    const std::string key = name.substr(std::string("particles.").size());
+    if (
+      std::find(amrex_inputs.begin(), amrex_inputs.end(), key) ==
+        amrex_inputs.end() &&
+      std::find(m_ignoreInputs.begin(), m_ignoreInputs.end(), key) ==
+        m_ignoreInputs.end()) {
+      unused_inputs += " " + name;
+    }
+  }
+  if (!unused_inputs.empty()) {
+    const std::string msg =
+      "Spray inputs not recognized or not used with the selected models:" +
+      unused_inputs;
+    if (m_strictInputs) {
+      Abort(msg);
+    }
+    Print() << "Warning: " << msg << std::endl;
+  }
 }
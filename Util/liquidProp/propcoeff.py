@@ -9,6 +9,10 @@
 
 # Usage:
 # python propfit.py --species NC10H22 --file_loc decane --units MKS --vars rho
+# With --table N, rho, mu, lambda, and psat are also tabulated at N uniformly
+# spaced temperatures over the range covered by all of their data and written
+# to prop_table.dat in the data directory, which can be used in place of the
+# fits with particles.<species>_prop_table
 
 import sys
 import csv
@@ -25,8 +29,12 @@ parser.add_argument("--species", help="Species name", metavar="NC10H22", type=st
 parser.add_argument("--file_loc", help="Location of data files. Files should be called rho.dat, mu.dat, and/or lambda.dat", type=str,default="None")
 parser.add_argument("--units", help="Units, either MKS or CGS", type=str,default="MKS")
 parser.add_argument("--vars", help="Which variables to fit, ex. mu lambda rho", default="None",nargs='+', type=str)
+parser.add_argument("--table", help="Number of temperatures in the property table, at most 64; 0 for no table", default=0, type=int)
 arg_string = sys.argv[1:]
 args = parser.parse_args()
+# Checked before fitting, the table size is limited by LiquidPropTable::max_pts
+if (args.table != 0 and (args.table < 2 or args.table > 64)):
+    raise ValueError("Number of table temperatures must be between 2 and 64")
 Tmin = 280.
 
 def mufit(T, a, b, c, d):
@@ -156,6 +164,9 @@ for i in range(numvar):
         raise ValueError(errorstatement)
 
 coeffs = []
+# Data for the property table in the output units
+tabvarnames = ["rho", "mu", "lambda", "psat"]
+tabdata = {}
 for f in range(len(varnames)):
     infile = args.file_loc + "/" + varnames[f] + ".dat"
     if (varnames[f] == "psat"):
@@ -164,6 +175,7 @@ for f in range(len(varnames)):
             p = np.append(p, 1.E6)
         else:
             p = np.append(p, 1.E5)
+        tabdata["psat"] = [T, prop * p[-1]]
         plt.plot(T, vfit)
         plt.scatter(T, prop)
         plt.show()
@@ -179,6 +191,11 @@ for f in range(len(varnames)):
         if (args.units == "CGS"):
             for i in range(len(p)):
                 p[i] *= cgs_conv[f]
+        if (varnames[f] in tabvarnames):
+            tconv = 1.
+            if (args.units == "CGS"):
+                tconv = cgs_conv[f]
+            tabdata[varnames[f]] = [T, prop * tconv]
         plt.plot(T, vfit)
         plt.scatter(T, prop)
         plt.show()
@@ -190,3 +207,24 @@ for f in range(len(varnames)):
     for i in range(len(coeffs[f])):
         curcoeffs += "{:g} ".format(coeffs[f][i])
     print("particles." + args.file_loc + "_" + varnames[f] + " = " + curcoeffs)
+if (args.table > 0 and len(tabdata) > 0):
+    tabvars = [var for var in tabvarnames if var in tabdata]
+    Tlo = max([min(tabdata[var][0]) for var in tabvars])
+    Thi = min([max(tabdata[var][0]) for var in tabvars])
+    if (Thi <= Tlo):
+        raise ValueError("Temperature ranges of the tabulated data do not overlap")
+    Ttab = np.linspace(Tlo, Thi, args.table)
+    tabcols = [Ttab]
+    for var in tabvars:
+        [T, prop] = tabdata[var]
+        order = np.argsort(T)
+        # Viscosity and saturation pressure vary exponentially with T
+        if (var == "mu" or var == "psat"):
+            tabcols.append(np.exp(np.interp(Ttab, T[order], np.log(prop[order]))))
+        else:
+            tabcols.append(np.interp(Ttab, T[order], prop[order]))
+    tabfile = args.file_loc + "/prop_table.dat"
+    header = "# Liquid properties of " + speciesname + " in " + args.units + " units\n"
+    header += "T " + " ".join(tabvars)
+    np.savetxt(tabfile, np.column_stack(tabcols), fmt="%.10g", header=header, comments="")
+    print("particles." + args.file_loc + "_prop_table = " + tabfile)
@@ -0,0 +1,50 @@
+#!/usr/bin/env python
+
+# This code converts an ascii spray initialization file, as read by
+# particles.init_file, into the binary format that is read in parallel
+# The ascii file contains the number of parcels followed by the position and
+# the real components of each parcel
+# The binary file contains the tag PMSPRAY1, the number of parcels (int64),
+# the number of dimensions, the number of components, the size of the reals
+# in bytes, and a reserved value (int32 each), followed by the parcel data
+# Data is written in the native byte order
+
+# Usage:
+# python ascii2binary.py --input initspraydata --output initspraydata.bin --dim 3
+
+import sys
+import struct
+import argparse
+import numpy as np
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument("--input", help="Ascii spray file", type=str, required=True)
+parser.add_argument("--output", help="Binary spray file", type=str, required=True)
+parser.add_argument("--dim", help="Number of dimensions", type=int, default=3)
+parser.add_argument("--precision", help="Precision of the reals, double or single", type=str, default="double")
+arg_string = sys.argv[1:]
+args = parser.parse_args()
+
+data = np.fromfile(args.input, sep=" ")
+if (len(data) < 1):
+    sys.exit("No data found in " + args.input)
+num_parcels = int(data[0])
+num_vals = len(data) - 1
+if (num_parcels < 1 or num_vals % num_parcels != 0):
+    sys.exit("Number of values does not match the number of parcels")
+num_comps = num_vals // num_parcels - args.dim
+if (num_comps < 1):
+    sys.exit("Number of components must be positive")
+if (args.precision == "double"):
+    dtype = np.float64
+elif (args.precision == "single"):
+    dtype = np.float32
+else:
+    sys.exit("Precision must be double or single")
+real_size = np.dtype(dtype).itemsize
+with open(args.output, "wb") as outfile:
+    outfile.write(b"PMSPRAY1")
+    outfile.write(struct.pack("=qiiii", num_parcels, args.dim, num_comps, real_size, 0))
+    data[1:].astype(dtype).tofile(outfile)
+print("Wrote " + str(num_parcels) + " parcels with " + str(num_comps) + " components to " + args.output)